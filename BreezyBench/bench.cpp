@@ -0,0 +1,346 @@
+// bench.cpp : Runs the meadow simulation for fixed scenarios and reports frame times as JSON.
+//
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "types.h"
+#include "blades.h"
+#include "jobs.h"
+#include "wind.h"
+#include "trample.h"
+#include "chunks.h"
+#include "softraster.h"
+#include "verletblades.h"
+
+constexpr float BENCH_DT = 1.f / 120.f; // same fixed step as the game
+constexpr int BENCH_RENDER_WIDTH = 1920;
+constexpr int BENCH_RENDER_HEIGHT = 1080;
+// the freshly seeded meadow takes about 3 s to settle enough for calm chunks to fall asleep
+constexpr int BENCH_WARMUP = 600;
+static_assert(BENCH_WARMUP * BENCH_DT > 4.f * CHUNK_SLEEP_TIME, "warm up until chunks have had time to sleep");
+
+enum class eWindPreset {
+	CALM,
+	GUSTY
+};
+
+struct Scenario {
+	const char* name;
+	size_t blades;
+	eWindPreset wind;
+};
+
+const Scenario SCENARIOS[] = {
+	{ "10k_calm", 10000, eWindPreset::CALM },
+	{ "10k_gusty", 10000, eWindPreset::GUSTY },
+	{ "1m_calm", 1000000, eWindPreset::CALM },
+	{ "1m_gusty", 1000000, eWindPreset::GUSTY },
+	{ "10m_calm", 10000000, eWindPreset::CALM },
+	{ "10m_gusty", 10000000, eWindPreset::GUSTY },
+};
+
+struct BenchOptions {
+	int frames = 300;
+	int warmup = BENCH_WARMUP;
+	uint32_t seed = 1337;
+	int threads = -1; // workers; -1 means one per extra core
+	bool render = false;
+	bool articulated = false; // VERLET_SEGMENTS piece blades instead of the single angle kernel
+	bool sleep = true;        // let settled chunks sleep
+	std::string filter; // substring of scenario names to run
+	std::string output; // JSON file, stdout when empty
+};
+
+struct BenchResult {
+	const Scenario* scenario = nullptr;
+	double mean_ms = 0.0;
+	double p50_ms = 0.0;
+	double p99_ms = 0.0;
+	double min_ms = 0.0;
+	double max_ms = 0.0;
+	double blades_per_sec = 0.0;
+	double peak_rss_mb = 0.0;
+	double asleep = 0.0; // share of chunks asleep after the last frame
+};
+
+WindParams windPreset(eWindPreset preset) {
+	WindParams params;
+	if (preset == eWindPreset::CALM) {
+		params.strength = 2.f;
+		params.turbulence = 0.3f;
+		params.gust_rate = 0.f;
+	}
+	else {
+		params.strength = 10.f;
+		params.turbulence = 0.9f;
+		params.gust_rate = 1.5f;
+		params.gust_strength = 22.f;
+	}
+	return params;
+}
+
+// process-wide high-water mark, so scenarios run smallest first
+double peakRssMB() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0.0;
+	return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+	return usage.ru_maxrss / 1024.0;            // kilobytes
+#endif
+#endif
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+	if (sorted.empty()) return 0.0;
+	size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// one frame is one simulation step, mirroring update() in breezygrass.cpp, plus an optional CPU raster
+bool runScenario(const Scenario& scenario, const BenchOptions& options, JobSystem& jobs, BenchResult& result) {
+	const Vector2<float> area{ static_cast<float>(BENCH_RENDER_WIDTH), static_cast<float>(BENCH_RENDER_HEIGHT) };
+
+	BladeField field;
+	if (!field.allocate(scenario.blades)) {
+		return false;
+	}
+	seedBlades(field, area, options.seed);
+
+	// the whole meadow is in view, so every chunk steps every frame
+	ChunkGrid chunks;
+	chunks.allow_sleep = options.sleep;
+	if (!chunks.build(field, area)) {
+		return false;
+	}
+	chunks.updateVisibility(Rect<float>{ 0.f, 0.f, area.x, area.y });
+
+	VerletBlades<VERLET_SEGMENTS> articulated;
+	if (options.articulated && !articulated.build(field)) {
+		return false;
+	}
+	BladeStepper step_articulated = [&](BladeField& blades, size_t begin, size_t end, float dt) {
+		articulated.step(blades, begin, end, dt);
+	};
+
+	WindField wind;
+	wind.params = windPreset(scenario.wind);
+	wind.init(area, options.seed);
+
+	// nothing walks through the bench meadow
+	TrampleField trample;
+	trample.init(area);
+
+	SoftRasterizer rasterizer;
+	std::vector<uint32_t> pixels;
+	FrameTarget target{ nullptr, BENCH_RENDER_WIDTH, BENCH_RENDER_WIDTH, BENCH_RENDER_HEIGHT };
+	if (options.render) {
+		pixels.resize(static_cast<size_t>(BENCH_RENDER_WIDTH) * BENCH_RENDER_HEIGHT);
+		target.pixels = pixels.data();
+	}
+
+	const double counter_frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+	std::vector<double> frame_ms;
+	frame_ms.reserve(options.frames);
+	float time = 0.f;
+
+	for (int frame = 0; frame < options.warmup + options.frames; frame++) {
+		Uint64 start = SDL_GetPerformanceCounter();
+
+		wind.update(time, BENCH_DT);
+		if (options.articulated) {
+			chunks.step(field, wind, trample, BENCH_DT, jobs, step_articulated);
+		}
+		else {
+			chunks.step(field, wind, trample, BENCH_DT, jobs);
+		}
+		time += BENCH_DT;
+
+		if (options.render) {
+			rasterizer.render(target, field, chunks.visibleRanges(), 1.f, jobs);
+		}
+
+		Uint64 end = SDL_GetPerformanceCounter();
+		if (frame >= options.warmup) {
+			frame_ms.push_back((end - start) * 1000.0 / counter_frequency);
+		}
+	}
+
+	double total_ms = 0.0;
+	for (double ms : frame_ms) total_ms += ms;
+	std::sort(frame_ms.begin(), frame_ms.end());
+
+	result.scenario = &scenario;
+	result.mean_ms = total_ms / frame_ms.size();
+	result.p50_ms = percentile(frame_ms, 0.5);
+	result.p99_ms = percentile(frame_ms, 0.99);
+	result.min_ms = frame_ms.front();
+	result.max_ms = frame_ms.back();
+	result.blades_per_sec = total_ms > 0.0 ? scenario.blades * frame_ms.size() / (total_ms / 1000.0) : 0.0;
+	result.peak_rss_mb = peakRssMB();
+	result.asleep = static_cast<double>(chunks.sleepingChunks()) / chunks.chunks.size();
+	return true;
+}
+
+void writeJson(FILE* file, const BenchOptions& options, int thread_count, const std::vector<BenchResult>& results) {
+	fprintf(file, "{\n");
+	fprintf(file, "  \"seed\": %u,\n", options.seed);
+	fprintf(file, "  \"frames\": %d,\n", options.frames);
+	fprintf(file, "  \"warmup\": %d,\n", options.warmup);
+	fprintf(file, "  \"threads\": %d,\n", thread_count);
+	fprintf(file, "  \"kernel\": \"%s\",\n", simdLevelName(getBladeKernel()));
+	fprintf(file, "  \"model\": \"%s\",\n", options.articulated ? "articulated" : "angle");
+	fprintf(file, "  \"render\": %s,\n", options.render ? "true" : "false");
+	fprintf(file, "  \"sleep\": %s,\n", options.sleep ? "true" : "false");
+	fprintf(file, "  \"scenarios\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& r = results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"blades\": %zu, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, "
+			"\"min_ms\": %.4f, \"max_ms\": %.4f, \"blades_per_sec\": %.0f, \"peak_rss_mb\": %.1f, \"asleep\": %.3f }%s\n",
+			r.scenario->name, r.scenario->blades, r.mean_ms, r.p50_ms, r.p99_ms,
+			r.min_ms, r.max_ms, r.blades_per_sec, r.peak_rss_mb, r.asleep, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+void printUsage() {
+	std::cerr << "Usage: BreezyBench [--frames N] [--warmup N] [--seed N] [--threads N] [--render] [--articulated] [--no-sleep] [--scenario NAME] [--output PATH]\n"
+		<< "Scenarios:";
+	for (const Scenario& scenario : SCENARIOS) std::cerr << " " << scenario.name;
+	std::cerr << "\n";
+}
+
+bool matchesScenario(const std::string& filter) {
+	for (const Scenario& scenario : SCENARIOS) {
+		if (strstr(scenario.name, filter.c_str()) != NULL) return true;
+	}
+	return false;
+}
+
+bool parseArguments(int argc, char* argv[], BenchOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (strcmp(arg, "--frames") == 0 && has_value) {
+			options.frames = std::max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(arg, "--warmup") == 0 && has_value) {
+			options.warmup = std::max(atoi(argv[++i]), 0);
+		}
+		else if (strcmp(arg, "--seed") == 0 && has_value) {
+			options.seed = static_cast<uint32_t>(strtoul(argv[++i], NULL, 10));
+		}
+		else if (strcmp(arg, "--threads") == 0 && has_value) {
+			options.threads = atoi(argv[++i]);
+		}
+		else if (strcmp(arg, "--render") == 0) {
+			options.render = true;
+		}
+		else if (strcmp(arg, "--articulated") == 0) {
+			options.articulated = true;
+		}
+		else if (strcmp(arg, "--no-sleep") == 0) {
+			options.sleep = false;
+		}
+		else if (strcmp(arg, "--scenario") == 0 && has_value) {
+			options.filter = argv[++i];
+		}
+		else if (strcmp(arg, "--output") == 0 && has_value) {
+			options.output = argv[++i];
+		}
+		else {
+			std::cerr << "Unknown argument: " << arg << "\n";
+			printUsage();
+			return false;
+		}
+	}
+
+	if (!options.filter.empty() && !matchesScenario(options.filter)) {
+		std::cerr << "Unknown scenario: " << options.filter << "\n";
+		printUsage();
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchOptions options;
+	if (!parseArguments(argc, argv, options)) {
+		return EXIT_FAILURE;
+	}
+
+	if (SDL_Init(0) != 0) {
+		std::cerr << "Failed to initialize SDL:" << SDL_GetError() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	JobSystem jobs;
+	jobs.start(options.threads < 0 ? SDL_GetCPUCount() - 1 : options.threads);
+	setBladeKernel(detectBladeKernel());
+
+	std::vector<BenchResult> results;
+	for (const Scenario& scenario : SCENARIOS) {
+		if (!options.filter.empty() && strstr(scenario.name, options.filter.c_str()) == NULL) continue;
+
+		std::cerr << "Running " << scenario.name << "...\n";
+		BenchResult result;
+		if (!runScenario(scenario, options, jobs, result)) {
+			std::cerr << "Scenario " << scenario.name << " failed\n";
+			jobs.stop();
+			SDL_Quit();
+			return EXIT_FAILURE;
+		}
+		results.push_back(result);
+	}
+
+	FILE* file = stdout;
+	if (!options.output.empty()) {
+#ifdef _MSC_VER
+		if (fopen_s(&file, options.output.c_str(), "w") != 0) file = NULL;
+#else
+		file = fopen(options.output.c_str(), "w");
+#endif
+		if (!file) {
+			std::cerr << "Could not open " << options.output << "\n";
+			jobs.stop();
+			SDL_Quit();
+			return EXIT_FAILURE;
+		}
+	}
+
+	writeJson(file, options, jobs.threadCount(), results);
+	if (file != stdout) fclose(file);
+
+	jobs.stop();
+	SDL_Quit();
+
+	return EXIT_SUCCESS;
+}
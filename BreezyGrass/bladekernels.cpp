@@ -0,0 +1,202 @@
+// Blade integration kernels.
+// Every path performs the same operations in the same order (no fused multiply-add),
+// so the vector paths agree with the scalar reference to within rounding of the clamp.
+
+#include <math.h>
+#include <algorithm>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#include "blades.h"
+
+namespace {
+	eSimdLevel active_kernel = eSimdLevel::SCALAR;
+
+	void stepScalar(BladeField& field, size_t begin, size_t end, const BladeStepParams& params) {
+		float* angle = field.angle;
+		float* prev_angle = field.prev_angle;
+		float* velocity = field.angular_velocity;
+		const float* stiffness = field.stiffness;
+		const float* wind = field.wind;
+
+		for (size_t i = begin; i < end; i++) {
+			prev_angle[i] = angle[i];
+
+			float accel = wind[i] - stiffness[i] * angle[i] - BLADE_DAMPING * velocity[i];
+			float v = velocity[i] + accel * params.dt;
+			float a = angle[i] + v * params.dt;
+
+			angle[i] = std::min(std::max(a, -BLADE_MAX_BEND), BLADE_MAX_BEND);
+			velocity[i] = v;
+		}
+	}
+
+#if SIMD_X86
+	SIMD_TARGET_SSE2
+	void stepSSE2(BladeField& field, size_t begin, size_t end, const BladeStepParams& params) {
+		const __m128 dt = _mm_set1_ps(params.dt);
+		const __m128 damping = _mm_set1_ps(BLADE_DAMPING);
+		const __m128 lo = _mm_set1_ps(-BLADE_MAX_BEND);
+		const __m128 hi = _mm_set1_ps(BLADE_MAX_BEND);
+
+		for (size_t i = begin; i < end; i += 4) {
+			__m128 a = _mm_load_ps(field.angle + i);
+			__m128 v = _mm_load_ps(field.angular_velocity + i);
+			__m128 k = _mm_load_ps(field.stiffness + i);
+			__m128 wind = _mm_load_ps(field.wind + i);
+			_mm_store_ps(field.prev_angle + i, a);
+
+			__m128 accel = _mm_sub_ps(_mm_sub_ps(wind, _mm_mul_ps(k, a)), _mm_mul_ps(damping, v));
+			v = _mm_add_ps(v, _mm_mul_ps(accel, dt));
+			a = _mm_add_ps(a, _mm_mul_ps(v, dt));
+
+			_mm_store_ps(field.angle + i, _mm_min_ps(_mm_max_ps(a, lo), hi));
+			_mm_store_ps(field.angular_velocity + i, v);
+		}
+	}
+
+	SIMD_TARGET_AVX2
+	void stepAVX2(BladeField& field, size_t begin, size_t end, const BladeStepParams& params) {
+		const __m256 dt = _mm256_set1_ps(params.dt);
+		const __m256 damping = _mm256_set1_ps(BLADE_DAMPING);
+		const __m256 lo = _mm256_set1_ps(-BLADE_MAX_BEND);
+		const __m256 hi = _mm256_set1_ps(BLADE_MAX_BEND);
+
+		for (size_t i = begin; i < end; i += 8) {
+			__m256 a = _mm256_load_ps(field.angle + i);
+			__m256 v = _mm256_load_ps(field.angular_velocity + i);
+			__m256 k = _mm256_load_ps(field.stiffness + i);
+			__m256 wind = _mm256_load_ps(field.wind + i);
+			_mm256_store_ps(field.prev_angle + i, a);
+
+			__m256 accel = _mm256_sub_ps(_mm256_sub_ps(wind, _mm256_mul_ps(k, a)), _mm256_mul_ps(damping, v));
+			v = _mm256_add_ps(v, _mm256_mul_ps(accel, dt));
+			a = _mm256_add_ps(a, _mm256_mul_ps(v, dt));
+
+			_mm256_store_ps(field.angle + i, _mm256_min_ps(_mm256_max_ps(a, lo), hi));
+			_mm256_store_ps(field.angular_velocity + i, v);
+		}
+	}
+
+	SIMD_TARGET_AVX512
+	void stepAVX512(BladeField& field, size_t begin, size_t end, const BladeStepParams& params) {
+		const __m512 dt = _mm512_set1_ps(params.dt);
+		const __m512 damping = _mm512_set1_ps(BLADE_DAMPING);
+		const __m512 lo = _mm512_set1_ps(-BLADE_MAX_BEND);
+		const __m512 hi = _mm512_set1_ps(BLADE_MAX_BEND);
+
+		for (size_t i = begin; i < end; i += 16) {
+			__m512 a = _mm512_load_ps(field.angle + i);
+			__m512 v = _mm512_load_ps(field.angular_velocity + i);
+			__m512 k = _mm512_load_ps(field.stiffness + i);
+			__m512 wind = _mm512_load_ps(field.wind + i);
+			_mm512_store_ps(field.prev_angle + i, a);
+
+			__m512 accel = _mm512_sub_ps(_mm512_sub_ps(wind, _mm512_mul_ps(k, a)), _mm512_mul_ps(damping, v));
+			v = _mm512_add_ps(v, _mm512_mul_ps(accel, dt));
+			a = _mm512_add_ps(a, _mm512_mul_ps(v, dt));
+
+			_mm512_store_ps(field.angle + i, _mm512_min_ps(_mm512_max_ps(a, lo), hi));
+			_mm512_store_ps(field.angular_velocity + i, v);
+		}
+	}
+#endif
+}
+
+// whether this CPU can run kernels of the given level
+bool bladeKernelSupported(eSimdLevel level) {
+	switch (level) {
+	case eSimdLevel::SCALAR: return true;
+#if SIMD_X86
+	case eSimdLevel::SSE2: return SDL_HasSSE2() == SDL_TRUE;
+	case eSimdLevel::AVX2: return SDL_HasAVX2() == SDL_TRUE;
+	case eSimdLevel::AVX512: return SDL_HasAVX512F() == SDL_TRUE;
+#endif
+	default: return false;
+	}
+}
+
+// widest kernel this CPU can run
+eSimdLevel detectBladeKernel() {
+	if (bladeKernelSupported(eSimdLevel::AVX512)) return eSimdLevel::AVX512;
+	if (bladeKernelSupported(eSimdLevel::AVX2)) return eSimdLevel::AVX2;
+	if (bladeKernelSupported(eSimdLevel::SSE2)) return eSimdLevel::SSE2;
+	return eSimdLevel::SCALAR;
+}
+
+bool setBladeKernel(eSimdLevel level) {
+	if (!bladeKernelSupported(level)) {
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Blade kernel %s is not supported on this CPU", simdLevelName(level));
+		return false;
+	}
+
+	active_kernel = level;
+	return true;
+}
+
+eSimdLevel getBladeKernel() {
+	return active_kernel;
+}
+
+BladeKernel bladeKernel(eSimdLevel level) {
+	switch (level) {
+#if SIMD_X86
+	case eSimdLevel::SSE2: return stepSSE2;
+	case eSimdLevel::AVX2: return stepAVX2;
+	case eSimdLevel::AVX512: return stepAVX512;
+#endif
+	default: return stepScalar;
+	}
+}
+
+// Run every supported kernel on the same random field for a number of steps and
+// return the largest difference in bend angle against the scalar reference.
+float validateBladeKernels() {
+	constexpr size_t test_blades = 4 * BLADE_LANES + 3;
+	constexpr int test_steps = 240;
+
+	BladeField reference;
+	if (!reference.allocate(test_blades)) return INFINITY;
+	seedBlades(reference, Vector2<float>{ 100.f, 100.f }, 42);
+
+	// a different push per blade and per step
+	auto blowWind = [](BladeField& field, int step) {
+		for (size_t i = 0; i < field.capacity; i++) {
+			field.wind[i] = 10.f * sinf(step * 0.1f + i * 0.37f);
+		}
+	};
+
+	BladeStepParams params{ 1.f / 120.f };
+	for (int step = 0; step < test_steps; step++) {
+		blowWind(reference, step);
+		stepScalar(reference, 0, reference.capacity, params);
+	}
+
+	float max_error = 0.f;
+	for (eSimdLevel level : { eSimdLevel::SSE2, eSimdLevel::AVX2, eSimdLevel::AVX512 }) {
+		if (!bladeKernelSupported(level)) continue;
+
+		BladeField field;
+		if (!field.allocate(test_blades)) return INFINITY;
+		seedBlades(field, Vector2<float>{ 100.f, 100.f }, 42);
+
+		BladeKernel kernel = bladeKernel(level);
+		for (int step = 0; step < test_steps; step++) {
+			blowWind(field, step);
+			kernel(field, 0, field.capacity, params);
+		}
+
+		float error = 0.f;
+		for (size_t i = 0; i < field.count; i++) {
+			error = std::max(error, fabsf(field.angle[i] - reference.angle[i]));
+		}
+
+		SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "Blade kernel %s max error vs scalar: %g", simdLevelName(level), error);
+		max_error = std::max(max_error, error);
+	}
+
+	return max_error;
+}
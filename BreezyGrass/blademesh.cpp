@@ -0,0 +1,96 @@
+#include <math.h>
+#include <algorithm>
+
+#include "blademesh.h"
+#include "fasttrig.h"
+#include "profiler.h"
+
+size_t bladeMeshVertices(const std::vector<BladeRange>& ranges, int segments) {
+	size_t blades = 0;
+	for (const BladeRange& range : ranges) {
+		blades += range.end - range.begin;
+	}
+	return blades * bladeMeshVertices(segments);
+}
+
+void blade_mesh::stripColors(SDL_Color* colors, int segments, const BladeField& field, size_t i) {
+	const BladeArchetype& archetype = bladeArchetype(field, i);
+	const RGB root_color = shadeColor(archetype.root_color, field.traits[i].shade);
+	const RGB tip_color = shadeColor(archetype.tip_color, field.traits[i].shade);
+	for (int k = 0; k <= segments; k++) {
+		float t = static_cast<float>(k) / segments;
+		colors[k] = SDL_Color{
+			static_cast<Uint8>(root_color.R + (tip_color.R - root_color.R) * t),
+			static_cast<Uint8>(root_color.G + (tip_color.G - root_color.G) * t),
+			static_cast<Uint8>(root_color.B + (tip_color.B - root_color.B) * t),
+			SDL_ALPHA_OPAQUE };
+	}
+}
+
+// Each spine point is pushed out either side along the normal of the spine through it.
+Vertex* blade_mesh::writeStrip(Vertex* out, const SDL_FPoint* spine, const SDL_Color* colors, int segments, float half_width, float taper) {
+	SDL_FPoint left[blade_mesh::MAX_SEGMENTS + 1];
+	SDL_FPoint right[blade_mesh::MAX_SEGMENTS + 1];
+	const SDL_FPoint no_texture{ 0.f, 0.f };
+
+	for (int k = 0; k <= segments; k++) {
+		const SDL_FPoint& from = spine[std::max(k - 1, 0)];
+		const SDL_FPoint& to = spine[std::min(k + 1, segments)];
+		float dx = to.x - from.x;
+		float dy = to.y - from.y;
+		float length = sqrtf(dx * dx + dy * dy);
+		float w = length > 0.f ? half_width * (1.f - taper * k / segments) / length : 0.f;
+		left[k] = SDL_FPoint{ spine[k].x - dy * w, spine[k].y + dx * w };
+		right[k] = SDL_FPoint{ spine[k].x + dy * w, spine[k].y - dx * w };
+	}
+
+	for (int k = 0; k < segments - 1; k++) {
+		*out++ = Vertex{ left[k], colors[k], no_texture };
+		*out++ = Vertex{ right[k], colors[k], no_texture };
+		*out++ = Vertex{ left[k + 1], colors[k + 1], no_texture };
+
+		*out++ = Vertex{ right[k], colors[k], no_texture };
+		*out++ = Vertex{ right[k + 1], colors[k + 1], no_texture };
+		*out++ = Vertex{ left[k + 1], colors[k + 1], no_texture };
+	}
+
+	const int last = segments - 1;
+	*out++ = Vertex{ left[last], colors[last], no_texture };
+	*out++ = Vertex{ right[last], colors[last], no_texture };
+	*out++ = Vertex{ spine[segments], colors[segments], no_texture };
+	return out;
+}
+
+void buildBladeMesh(Vertex* out, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, const Camera& camera) {
+	PROFILE_SCOPE("blade mesh");
+
+	SDL_Color colors[BLADE_MESH_SEGMENTS + 1];
+	SDL_FPoint spine[BLADE_MESH_SEGMENTS + 1];
+	for (const BladeRange& range : ranges) {
+		for (size_t i = range.begin; i < range.end; i++) {
+			blade_mesh::stripColors(colors, BLADE_MESH_SEGMENTS, field, i);
+
+			float s, c;
+			fastSinCos(interpolatedAngle(field, i, alpha), s, c);
+
+			const float h = bladeHeight(field, i) * camera.zoom;
+			const float rx = camera.toScreenX(field.root_x[i]);
+			const float ry = camera.toScreenY(field.root_y[i]);
+
+			// control point and tip relative to the root
+			const float cy = -h * BLADE_MESH_CONTROL;
+			const float tx = h * s;
+			const float ty = -h * c;
+
+			// B(t) = 2ut C + t^2 T with the root at the origin
+			for (int k = 0; k <= BLADE_MESH_SEGMENTS; k++) {
+				float t = static_cast<float>(k) / BLADE_MESH_SEGMENTS;
+				float u = 1.f - t;
+				spine[k] = SDL_FPoint{ rx + t * t * tx, ry + 2.f * u * t * cy + t * t * ty };
+			}
+
+			const float half_width = 0.5f * std::max(h * bladeWidthRatio(field, i), BLADE_MIN_WIDTH);
+			out = blade_mesh::writeStrip(out, spine, colors, BLADE_MESH_SEGMENTS, half_width, bladeArchetype(field, i).taper);
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#include "types.h"
+#include "blades.h"
+#include "camera.h"
+#include "graphics.h"
+#include "verletblades.h"
+
+constexpr int BLADE_MESH_SEGMENTS = 4;     // curve steps from root to tip
+constexpr float BLADE_MESH_CONTROL = 0.5f; // Bezier control point height above the root, as a fraction of the blade
+
+// the last step narrows to the tip and needs one triangle instead of two
+constexpr size_t bladeMeshVertices(int segments) { return static_cast<size_t>(2 * segments - 1) * 3; }
+
+// Each blade is a quadratic Bezier from its root to the tip of its bent stem, with the control
+// point straight above the root so the base stays upright and the bend gathers towards the tip.
+// The curve is swept into a strip that narrows to a point as the blade's archetype tapers, shaded
+// from its root to its tip colour, and written out as a triangle list since that is what the
+// render batch submits.
+size_t bladeMeshVertices(const std::vector<BladeRange>& ranges, int segments = BLADE_MESH_SEGMENTS);
+
+// fills exactly bladeMeshVertices(ranges) vertices, in screen space through camera
+void buildBladeMesh(Vertex* out, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, const Camera& camera);
+
+// shared by both generators
+namespace blade_mesh {
+	constexpr int MAX_SEGMENTS = 15;
+	// root to tip colours of blade i, with its shade applied
+	void stripColors(SDL_Color* colors, int segments, const BladeField& field, size_t i);
+	// segments + 1 points down the middle of a blade become a strip narrowing from half_width to nothing;
+	// the last node below the tip keeps 1 - taper * (segments - 1) / segments of it
+	Vertex* writeStrip(Vertex* out, const SDL_FPoint* spine, const SDL_Color* colors, int segments, float half_width, float taper);
+}
+
+// Same strip, following the nodes of articulated blades instead of a curve.
+template <int SEGMENTS>
+void buildArticulatedMesh(Vertex* out, const BladeField& field, const VerletBlades<SEGMENTS>& blades,
+	const std::vector<BladeRange>& ranges, float alpha, const Camera& camera) {
+	static_assert(SEGMENTS <= blade_mesh::MAX_SEGMENTS, "too many segments for a blade strip");
+	PROFILE_SCOPE("blade mesh");
+
+	SDL_Color colors[SEGMENTS + 1];
+	SDL_FPoint spine[SEGMENTS + 1];
+	for (const BladeRange& range : ranges) {
+		for (size_t i = range.begin; i < range.end; i++) {
+			blade_mesh::stripColors(colors, SEGMENTS, field, i);
+			const float rx = camera.toScreenX(field.root_x[i]);
+			const float ry = camera.toScreenY(field.root_y[i]);
+			for (int k = 0; k <= SEGMENTS; k++) {
+				Vector2<float> node = blades.node(i, k, alpha);
+				spine[k] = SDL_FPoint{ rx + node.x * camera.zoom, ry + node.y * camera.zoom };
+			}
+
+			const float half_width = 0.5f * std::max(bladeHeight(field, i) * camera.zoom * bladeWidthRatio(field, i), BLADE_MIN_WIDTH);
+			out = blade_mesh::writeStrip(out, spine, colors, SEGMENTS, half_width, bladeArchetype(field, i).taper);
+		}
+	}
+}
@@ -0,0 +1,153 @@
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#include "blades.h"
+
+namespace {
+	// small deterministic generator so a given seed always produces the same meadow
+	struct XorShift32 {
+		uint32_t state;
+
+		explicit XorShift32(uint32_t seed) : state{ seed ? seed : 0x9E3779B9u } {};
+
+		uint32_t next() {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+
+		// uniform in [0, 1)
+		float unit() {
+			return static_cast<float>(next() >> 8) * (1.f / 16777216.f);
+		}
+
+		float range(const Range<float>& r) {
+			return r.min + (r.max - r.min) * unit();
+		}
+	};
+
+	float* allocArray(size_t capacity) {
+		return static_cast<float*>(SDL_SIMDAlloc(capacity * sizeof(float)));
+	}
+}
+
+BladeField::~BladeField() {
+	release();
+}
+
+bool BladeField::allocate(size_t blade_count) {
+	release();
+
+	size_t padded = (blade_count + BLADE_LANES - 1) / BLADE_LANES * BLADE_LANES;
+	if (padded == 0) padded = BLADE_LANES;
+
+	root_x = allocArray(padded);
+	root_y = allocArray(padded);
+	stiffness = allocArray(padded);
+	traits = static_cast<BladeTraits*>(SDL_SIMDAlloc(padded * sizeof(BladeTraits)));
+	angle = allocArray(padded);
+	prev_angle = allocArray(padded);
+	angular_velocity = allocArray(padded);
+	wind = allocArray(padded);
+
+	if (!root_x || !root_y || !stiffness || !traits || !angle || !prev_angle || !angular_velocity || !wind) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not allocate blade field of %zu blades", blade_count);
+		release();
+		return false;
+	}
+
+	count = blade_count;
+	capacity = padded;
+
+	// padding lanes hold a blade of zero height at rest so kernels can step them harmlessly
+	memset(root_x, 0, capacity * sizeof(float));
+	memset(root_y, 0, capacity * sizeof(float));
+	std::fill(traits, traits + capacity, BladeTraits{});
+	memset(angle, 0, capacity * sizeof(float));
+	memset(prev_angle, 0, capacity * sizeof(float));
+	memset(angular_velocity, 0, capacity * sizeof(float));
+	memset(wind, 0, capacity * sizeof(float));
+	std::fill(stiffness, stiffness + capacity, BLADE_STIFFNESS_RANGE.min);
+
+	return true;
+}
+
+void BladeField::release() {
+	SDL_SIMDFree(root_x);
+	SDL_SIMDFree(root_y);
+	SDL_SIMDFree(stiffness);
+	SDL_SIMDFree(traits);
+	SDL_SIMDFree(angle);
+	SDL_SIMDFree(prev_angle);
+	SDL_SIMDFree(angular_velocity);
+	SDL_SIMDFree(wind);
+
+	root_x = root_y = stiffness = angle = prev_angle = angular_velocity = wind = nullptr;
+	traits = nullptr;
+	count = 0;
+	capacity = 0;
+}
+
+void BladeField::swap(BladeField& other) {
+	std::swap(count, other.count);
+	std::swap(capacity, other.capacity);
+	std::swap(root_x, other.root_x);
+	std::swap(root_y, other.root_y);
+	std::swap(stiffness, other.stiffness);
+	std::swap(traits, other.traits);
+	std::swap(angle, other.angle);
+	std::swap(prev_angle, other.prev_angle);
+	std::swap(angular_velocity, other.angular_velocity);
+	std::swap(wind, other.wind);
+}
+
+void BladeField::copyBlade(const BladeField& src, size_t from, size_t to) {
+	root_x[to] = src.root_x[from];
+	root_y[to] = src.root_y[from];
+	stiffness[to] = src.stiffness[from];
+	traits[to] = src.traits[from];
+	angle[to] = src.angle[from];
+	prev_angle[to] = src.prev_angle[from];
+	angular_velocity[to] = src.angular_velocity[from];
+	wind[to] = src.wind[from];
+}
+
+// scatter the allocated blades over the given area, picking archetypes by their share
+void seedBlades(BladeField& field, const Vector2<float> area, uint32_t seed) {
+	XorShift32 rng{ seed };
+
+	float total_share = 0.f;
+	for (const BladeArchetype& archetype : BLADE_ARCHETYPES) {
+		total_share += archetype.share;
+	}
+
+	for (size_t i = 0; i < field.count; i++) {
+		field.root_x[i] = area.x * rng.unit();
+		field.root_y[i] = area.y * rng.unit();
+
+		float pick = total_share * rng.unit();
+		size_t archetype = 1;
+		while (archetype + 1 < BLADE_ARCHETYPE_COUNT && pick >= BLADE_ARCHETYPES[archetype].share) {
+			pick -= BLADE_ARCHETYPES[archetype].share;
+			archetype++;
+		}
+
+		BladeTraits& traits = field.traits[i];
+		traits.archetype = static_cast<uint8_t>(archetype);
+		traits.height = static_cast<uint8_t>(rng.next() >> 24);
+		traits.width = static_cast<uint8_t>(rng.next() >> 24);
+		traits.shade = static_cast<uint8_t>(rng.next() >> 24);
+		field.stiffness[i] = rng.range(BLADE_ARCHETYPES[archetype].stiffness);
+		field.angle[i] = 0.f;
+		field.prev_angle[i] = 0.f;
+		field.angular_velocity[i] = 0.f;
+		field.wind[i] = 0.f;
+	}
+}
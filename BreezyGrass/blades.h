@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+
+#include "types.h"
+#include "simd.h"
+#include "jobs.h"
+
+// blade arrays are padded to a multiple of this many floats (one AVX-512 register)
+// so vector kernels can run over the padded range without a scalar tail.
+constexpr size_t BLADE_LANES = 16;
+
+// default physical parameters for seeded blades
+constexpr float BLADE_DAMPING = 2.5f;
+constexpr float BLADE_MAX_BEND = 1.4f; // radians either side of upright
+constexpr float BLADE_MIN_WIDTH = 1.5f;
+constexpr float BLADE_WIDTH_JITTER = 0.2f; // blades are up to this much wider or narrower than their archetype
+constexpr float BLADE_SHADE_JITTER = 0.15f; // and up to this much lighter or darker
+constexpr size_t BLADE_JOB_GRAIN = 64 * 1024; // blades per job, a multiple of BLADE_LANES
+constexpr float BLADE_KERNEL_TOLERANCE = 1e-4f; // max angle drift between kernel paths
+inline const Range<float> BLADE_HEIGHT_RANGE{ 12.f, 40.f };    // spans every archetype's heights
+inline const Range<float> BLADE_STIFFNESS_RANGE{ 18.f, 40.f }; // and stiffnesses
+
+// Shape shared by every blade of one kind of grass.
+struct BladeArchetype {
+	const char* name;
+	Range<float> height;    // world units, spread by each blade's height byte
+	Range<float> stiffness;
+	float width_ratio;      // root width as a fraction of height
+	float taper;            // share of the root width lost by the last node below the tip; 1 narrows evenly to a point
+	RGB root_color;
+	RGB tip_color;
+	float share;            // how common it is when seeding, relative to the others
+};
+
+// Entry 0 is the zero height blade chunk padding is made of; seeding never picks it.
+constexpr uint8_t BLADE_ARCHETYPE_NONE = 0;
+inline const BladeArchetype BLADE_ARCHETYPES[] = {
+	{ "none", { 0.f, 0.f }, { 18.f, 18.f }, 0.f, 1.f, { 0, 0, 0 }, { 0, 0, 0 }, 0.f },
+	{ "meadow grass", { 14.f, 34.f }, { 20.f, 36.f }, 0.08f, 1.f, { 50, 110, 40 }, { 150, 200, 80 }, 0.6f },
+	{ "fescue", { 12.f, 22.f }, { 28.f, 40.f }, 0.05f, 0.9f, { 40, 95, 55 }, { 120, 170, 110 }, 0.25f },
+	{ "tall grass", { 26.f, 40.f }, { 18.f, 26.f }, 0.065f, 0.7f, { 70, 110, 35 }, { 190, 190, 90 }, 0.15f },
+};
+constexpr size_t BLADE_ARCHETYPE_COUNT = sizeof(BLADE_ARCHETYPES) / sizeof(BLADE_ARCHETYPES[0]);
+static_assert(BLADE_ARCHETYPE_COUNT <= 256, "archetypes are indexed by a byte");
+
+// What sets one blade apart from the rest of its archetype, a byte each.
+// The jitter bytes map 0..255 onto the archetype's height range and onto
+// -1..1 of BLADE_WIDTH_JITTER and BLADE_SHADE_JITTER.
+struct BladeTraits {
+	uint8_t archetype = BLADE_ARCHETYPE_NONE;
+	uint8_t height = 0;
+	uint8_t width = 0;
+	uint8_t shade = 0;
+};
+static_assert(sizeof(BladeTraits) == 4, "blade traits should pack into four bytes");
+
+// Grass blades stored as structure-of-arrays.
+// Every array holds `capacity` entries and is allocated with SDL_SIMDAlloc, so each
+// one is a contiguous, aligned stream that can be walked linearly once per step.
+//
+// A blade's shape lives in its archetype; per blade there is only the root, the stiffness the
+// kernels read every step and four bytes of traits, 16 bytes in all, plus 16 of motion state.
+class BladeField {
+public:
+	size_t count = 0;    // blades in use, including any chunk padding
+	size_t capacity = 0; // count rounded up to BLADE_LANES
+
+	float* root_x = nullptr;
+	float* root_y = nullptr;
+	float* stiffness = nullptr;        // decoded from the archetype once at seeding, since every kernel lane needs it
+	BladeTraits* traits = nullptr;
+	float* angle = nullptr;            // bend from upright, radians (positive leans right)
+	float* prev_angle = nullptr;       // angle before the last step, for render interpolation
+	float* angular_velocity = nullptr; // radians per second
+	float* wind = nullptr;             // wind push sampled at the root for the current step
+
+	BladeField() = default;
+	~BladeField();
+	BladeField(const BladeField&) = delete;
+	BladeField& operator=(const BladeField&) = delete;
+
+	bool allocate(size_t blade_count);
+	void release();
+	void swap(BladeField& other);
+
+	// copy every per-blade array entry of blade `from` in src into slot `to`
+	void copyBlade(const BladeField& src, size_t from, size_t to);
+};
+
+class WindField;
+
+// blades [begin, end) of a field
+struct BladeRange {
+	size_t begin = 0;
+	size_t end = 0;
+};
+
+struct BladeStepParams {
+	float dt = 0.f;
+};
+
+// steps blades [begin, end); both bounds must be multiples of BLADE_LANES
+using BladeKernel = void (*)(BladeField& field, size_t begin, size_t end, const BladeStepParams& params);
+
+inline const BladeArchetype& bladeArchetype(const BladeField& field, size_t i) {
+	return BLADE_ARCHETYPES[field.traits[i].archetype];
+}
+
+// byte jitter to a factor within spread either side of one
+inline float traitJitter(uint8_t value, float spread) {
+	return 1.f + spread * (value * (2.f / 255.f) - 1.f);
+}
+
+inline float bladeHeight(const BladeField& field, size_t i) {
+	const BladeTraits traits = field.traits[i];
+	const Range<float>& range = BLADE_ARCHETYPES[traits.archetype].height;
+	return range.min + (range.max - range.min) * (traits.height * (1.f / 255.f));
+}
+
+// root width as a fraction of height
+inline float bladeWidthRatio(const BladeField& field, size_t i) {
+	const BladeTraits traits = field.traits[i];
+	return BLADE_ARCHETYPES[traits.archetype].width_ratio * traitJitter(traits.width, BLADE_WIDTH_JITTER);
+}
+
+inline RGB shadeColor(const RGB& color, uint8_t shade) {
+	const float f = traitJitter(shade, BLADE_SHADE_JITTER);
+	return RGB{
+		static_cast<uint8_t>(std::min(color.R * f, 255.f)),
+		static_cast<uint8_t>(std::min(color.G * f, 255.f)),
+		static_cast<uint8_t>(std::min(color.B * f, 255.f)) };
+}
+
+// bend at a point between the previous and current step (alpha in [0, 1])
+inline float interpolatedAngle(const BladeField& field, size_t i, float alpha) {
+	return field.prev_angle[i] + (field.angle[i] - field.prev_angle[i]) * alpha;
+}
+
+void seedBlades(BladeField& field, const Vector2<float> area, uint32_t seed);
+
+// kernel dispatch (bladekernels.cpp)
+bool bladeKernelSupported(eSimdLevel level);
+eSimdLevel detectBladeKernel();
+bool setBladeKernel(eSimdLevel level);
+eSimdLevel getBladeKernel();
+BladeKernel bladeKernel(eSimdLevel level);
+float validateBladeKernels();
@@ -8,16 +8,28 @@
 #pragma warning(pop)
 #undef main
 
+#include <stdio.h>
 #include <stdlib.h>     /* srand, rand */
+#include <string.h>
+#include <math.h>
 #include <iostream>
+#include <algorithm>
 
 #include "types.h"
 #include "graphics.h"
 #include "breezygrass.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-	int SDL_RENDERER_FLAGS = 0;
+	if (!parseArguments(argc, argv)) {
+		return EXIT_FAILURE;
+	}
+
+	if (is_headless) {
+		return runHeadless();
+	}
+
+	int SDL_RENDERER_FLAGS = frame_pacer.rendererFlags();
 	int SDL_WINDOW_INDEX = -1;
 
 	int SDL_WINDOW_FLAGS = 0;
@@ -34,6 +46,14 @@ int main()
 		return EXIT_FAILURE;
 	}
 
+	// text is only used by the profiler overlay, so running without fonts is fine
+	if (TTF_Init() != 0) {
+		std::cout << "Failed to initialize SDL_ttf: " << TTF_GetError() << "\n";
+	}
+	else if (!font_path.empty() && fonts.load(font_path)) {
+		profiler_overlay.setFont(fonts.get(eFontSize::SMALL));
+	}
+
 
 	// Create Window
 	window = SDL_CreateWindow("Test Window", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 0, 0, SDL_WINDOW_FLAGS);
@@ -45,6 +65,7 @@ int main()
 	// set window size
 	SDL_SetWindowMinimumSize(window, 100, 100);
 	SDL_GetWindowSize(window, &WINDOW_WIDTH, &WINDOW_HEIGHT);
+	window_size = Vector2<int>{ WINDOW_WIDTH, WINDOW_HEIGHT };
 
 	// Create Renderer
 	renderer = SDL_CreateRenderer(window, SDL_WINDOW_INDEX, SDL_RENDERER_FLAGS);
@@ -53,22 +74,110 @@ int main()
 		return EXIT_FAILURE;
 	}
 
-	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	draw_state.setColor(renderer, RGBA{ 0, 0, 0, 255 });
+	draw_state.setBlendMode(renderer, SDL_BLENDMODE_BLEND);
 	SDL_RenderClear(renderer); // initialize backbuffer
+	sim_rect = SDL_Rect{ 0, 0, window_size.x, window_size.y };
 	is_running = true; // everything was set up successfully
 
+	if (!initSimulation(meadowSize())) {
+		return EXIT_FAILURE;
+	}
+
+	// distant chunks are drawn as clumps; without the texture they are simply skipped
+	if (!lod_renderer.init(renderer, job_system)) {
+		std::cout << "Failed to build grass clump texture\n";
+	}
+
 	SDL_ShowWindow(window);
 
+	// physics runs in fixed SIM_DT steps; rendering happens once per loop and interpolates
+	const double counter_frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+	Uint64 previous_counter = SDL_GetPerformanceCounter();
+	double accumulator = 0.0;
+
 	while (is_running) {
-		handleEvents();
-		update();
-		if (render() == RENDER_RESULT::RENDER_FAILED) {
-			is_running = false;
-			break;
+		profiler.beginFrame();
+
+		// nothing to draw, so nap until something happens or the next batch of steps is due
+		if (!is_active) {
+			PROFILE_SCOPE("idle");
+			SDL_WaitEventTimeout(NULL, IDLE_WAIT_MS);
+		}
+
+		Uint64 counter = SDL_GetPerformanceCounter();
+		double frame_time = (counter - previous_counter) / counter_frequency;
+		previous_counter = counter;
+
+		accumulator += std::min(frame_time, MAX_FRAME_TIME);
+
+		{
+			PROFILE_SCOPE("events");
+			handleEvents();
+			applyPendingResize();
 		}
+
+		if (is_active) {
+			chunk_grid.updateVisibility(viewRect(), camera.zoom);
+			lod_selector.update(chunk_grid, camera.zoom);
+		}
+		else {
+			// with no view every chunk drops to the off-screen rate
+			chunk_grid.updateVisibility(Rect<float>{});
+			if (idle_mode == eIdleMode::PAUSE) accumulator = 0.0;
+		}
+
+		int steps = 0;
+		while (accumulator >= SIM_DT && steps < MAX_STEPS_PER_FRAME) {
+			update();
+			accumulator -= SIM_DT;
+			steps++;
+		}
+
+		// drop whatever we couldn't catch up on
+		if (steps == MAX_STEPS_PER_FRAME) {
+			accumulator = std::min(accumulator, static_cast<double>(SIM_DT));
+		}
+
+		sim_alpha = static_cast<float>(accumulator / SIM_DT);
+
+		if (is_active) {
+			// judge the render scale on drawing alone: events and simulation steps cost the same at any
+			// resolution, and time spent waiting in present says nothing about our own work
+			Uint64 render_counter = SDL_GetPerformanceCounter();
+			if (render() == RENDER_RESULT::RENDER_FAILED) {
+				is_running = false;
+				break;
+			}
+			double render_ms = (SDL_GetPerformanceCounter() - render_counter) * 1000.0 / counter_frequency;
+			{
+				PROFILE_SCOPE("present");
+				SDL_RenderPresent(renderer);
+			}
+			frame_pacer.framePresented();
+			render_scale.update(render_ms);
+		}
+		else {
+			frame_pacer.reset();
+		}
+
+		profiler.endFrame();
+	}
+
+	if (!trace_path.empty()) {
+		profiler.writeTrace(trace_path);
 	}
 
+	PacingStats pacing = frame_pacer.stats();
+	std::cout << "Frame pacing (" << pacingModeName(frame_pacer.mode) << "): mean " << pacing.mean_ms
+		<< " ms, jitter " << pacing.jitter_ms << " ms, worst " << pacing.worst_ms << " ms over the last " << pacing.frames << " frames\n";
+
+	// textures and fonts go before the renderer and SDL_ttf
+	if (sim_texture) SDL_DestroyTexture(sim_texture);
+	sim_texture = NULL;
+	lod_renderer.release();
+	profiler_overlay.release();
+	fonts.close();
 
 	// frees memory associated with renderer and window
 	SDL_DestroyRenderer(renderer);
@@ -76,44 +185,354 @@ int main()
 	renderer = NULL;
 	window = NULL;
 
-	// destroy textures
-	SDL_DestroyTexture(sim_texture);
+	shutdownSimulation();
 
+	TTF_Quit();
 	IMG_Quit();
 	SDL_Quit();
 
 	return 0;
 }
 
+// Start the job system, pick the blade kernel and plant the meadow.
+// Diagnostics go to stderr so stdout stays clean when frames are piped out of a headless run.
+bool initSimulation(const Vector2<float> area) {
+	// one worker per extra core; the main thread is the last one
+	if (!job_system.start(SDL_GetCPUCount() - 1)) {
+		std::cerr << "Failed to start job system, simulating on the main thread\n";
+	}
+	std::cerr << "Simulation threads: " << job_system.threadCount() << "\n";
+
+	// pick the widest blade kernel the CPU supports
+	setBladeKernel(detectBladeKernel());
+	std::cerr << "Blade kernel: " << simdLevelName(getBladeKernel()) << "\n";
+
+#ifdef _DEBUG
+	float kernel_error = validateBladeKernels();
+	if (kernel_error > BLADE_KERNEL_TOLERANCE) {
+		std::cerr << "Blade kernels disagree with scalar reference by " << kernel_error << "\n";
+	}
+	float verlet_error = validateVerletKernels();
+	if (verlet_error > BLADE_KERNEL_TOLERANCE) {
+		std::cerr << "Verlet kernels disagree with scalar reference by " << verlet_error << "\n";
+	}
+#endif
+
+	// plant the meadow
+	if (!blade_field.allocate(blade_count)) {
+		return false;
+	}
+	seedBlades(blade_field, area, blade_seed);
+	if (!chunk_grid.build(blade_field, area)) {
+		return false;
+	}
+	std::cerr << "Meadow chunks: " << chunk_grid.cols << "x" << chunk_grid.rows << "\n";
+
+	// built after the chunks, which reorder the field
+	if (is_articulated) {
+		if (!articulated_blades.build(blade_field)) {
+			return false;
+		}
+		lod_renderer.articulated = &articulated_blades;
+		std::cerr << "Blade model: articulated, " << VERLET_SEGMENTS << " segments\n";
+	}
+	wind_field.init(area, blade_seed);
+	trample_field.init(area);
+	sim_time = 0.f;
+
+	return true;
+}
+
+void shutdownSimulation() {
+	job_system.stop();
+	lod_renderer.articulated = nullptr;
+	articulated_blades.release();
+	blade_field.release();
+}
+
+// Offline rendering without a window: step the simulation at a fixed frame rate, rasterize
+// each frame on the CPU and hand it to the frame writer, which encodes on its own thread.
+int runHeadless() {
+	if (SDL_Init(0) != 0) {
+		std::cerr << "Failed to initialize SDL:" << SDL_GetError() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	if (!initSimulation(meadowSize())) {
+		SDL_Quit();
+		return EXIT_FAILURE;
+	}
+
+	FrameWriter writer;
+	if (!writer.open(headless_format, headless_output, window_size.x, window_size.y, headless_fps)) {
+		shutdownSimulation();
+		SDL_Quit();
+		return EXIT_FAILURE;
+	}
+
+	chunk_grid.updateVisibility(viewRect(), camera.zoom);
+	lod_selector.update(chunk_grid, camera.zoom);
+
+	const double frame_dt = 1.0 / headless_fps;
+	double accumulator = 0.0;
+
+	for (int frame = 0; frame < headless_frames; frame++) {
+		profiler.beginFrame();
+
+		accumulator += frame_dt;
+		while (accumulator >= SIM_DT) {
+			update();
+			accumulator -= SIM_DT;
+		}
+		sim_alpha = static_cast<float>(accumulator / SIM_DT);
+
+		{
+			PROFILE_SCOPE("render");
+			FrameTarget target{ writer.acquireFrame(), window_size.x, window_size.x, window_size.y };
+			soft_rasterizer.render(target, blade_field, lod_selector.bladeRanges(), sim_alpha, job_system, camera);
+			writer.submitFrame();
+		}
+
+		profiler.endFrame();
+	}
+
+	bool ok = writer.close();
+	if (!trace_path.empty()) {
+		profiler.writeTrace(trace_path);
+	}
+	std::cerr << "Wrote " << headless_frames << " frames to " << headless_output << (ok ? "\n" : " with errors\n");
+
+	shutdownSimulation();
+	IMG_Quit();
+	SDL_Quit();
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// command line options
+bool parseArguments(int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (strcmp(arg, "--cpu-raster") == 0) {
+			render_mode = eRenderMode::SOFTWARE;
+		}
+		else if (strcmp(arg, "--headless") == 0) {
+			is_headless = true;
+		}
+		else if (strcmp(arg, "--frames") == 0 && has_value) {
+			headless_frames = atoi(argv[++i]);
+		}
+		else if (strcmp(arg, "--fps") == 0 && has_value) {
+			headless_fps = std::max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(arg, "--size") == 0 && has_value) {
+			int w = 0, h = 0;
+			if (sscanf(argv[++i], "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+				std::cerr << "Bad --size, expected WIDTHxHEIGHT\n";
+				return false;
+			}
+			window_size = Vector2<int>{ w, h };
+		}
+		else if (strcmp(arg, "--output") == 0 && has_value) {
+			headless_output = argv[++i];
+		}
+		else if (strcmp(arg, "--format") == 0 && has_value) {
+			const char* format = argv[++i];
+			if (strcmp(format, "raw") == 0) headless_format = eFrameFormat::RAW;
+			else if (strcmp(format, "png") == 0) headless_format = eFrameFormat::PNG;
+			else if (strcmp(format, "y4m") == 0) headless_format = eFrameFormat::Y4M;
+			else {
+				std::cerr << "Unknown --format " << format << ", expected raw, png or y4m\n";
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--profile") == 0) {
+			profiler_overlay.visible = true;
+		}
+		else if (strcmp(arg, "--font") == 0 && has_value) {
+			font_path = argv[++i];
+		}
+		else if (strcmp(arg, "--trace") == 0 && has_value) {
+			trace_path = argv[++i];
+		}
+		else if (strcmp(arg, "--meadow") == 0 && has_value) {
+			int w = 0, h = 0;
+			if (sscanf(argv[++i], "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+				std::cerr << "Bad --meadow, expected WIDTHxHEIGHT\n";
+				return false;
+			}
+			meadow_size = Vector2<float>{ static_cast<float>(w), static_cast<float>(h) };
+		}
+		else if (strcmp(arg, "--blades") == 0 && has_value) {
+			blade_count = strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(arg, "--seed") == 0 && has_value) {
+			blade_seed = static_cast<uint32_t>(strtoul(argv[++i], NULL, 10));
+		}
+		else if (strcmp(arg, "--articulated") == 0) {
+			is_articulated = true;
+		}
+		else if (strcmp(arg, "--no-sleep") == 0) {
+			chunk_grid.allow_sleep = false;
+		}
+		else if (strcmp(arg, "--pacing") == 0 && has_value) {
+			const char* mode = argv[++i];
+			if (strcmp(mode, "vsync") == 0) frame_pacer.mode = ePacingMode::VSYNC;
+			else if (strcmp(mode, "cap") == 0) frame_pacer.mode = ePacingMode::CAP;
+			else if (strcmp(mode, "uncapped") == 0) frame_pacer.mode = ePacingMode::UNCAPPED;
+			else {
+				std::cerr << "Unknown --pacing " << mode << ", expected vsync, cap or uncapped\n";
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--cap") == 0 && has_value) {
+			frame_pacer.mode = ePacingMode::CAP;
+			frame_pacer.cap_fps = std::max(atof(argv[++i]), 1.0);
+		}
+		else if (strcmp(arg, "--idle-pause") == 0) {
+			idle_mode = eIdleMode::PAUSE;
+		}
+		else if (strcmp(arg, "--frame-budget") == 0 && has_value) {
+			render_scale.budget_ms = std::max(atof(argv[++i]), 0.0);
+		}
+		else if (strcmp(arg, "--render-scale") == 0 && has_value) {
+			float low = 0.f, high = 0.f;
+			int read = sscanf(argv[++i], "%f-%f", &low, &high);
+			if (read < 1 || low <= 0.f || low > 1.f || (read == 2 && (high < low || high > 1.f))) {
+				std::cerr << "Bad --render-scale, expected SCALE or MIN-MAX within (0, 1]\n";
+				return false;
+			}
+			render_scale.min_scale = low;
+			render_scale.max_scale = read == 2 ? high : low;
+			render_scale.reset(render_scale.max_scale);
+		}
+		else {
+			std::cerr << "Unknown argument: " << arg << "\n"
+				<< "Usage: BreezyGrass [--cpu-raster] [--blades N] [--meadow WxH] [--seed N] [--articulated] [--no-sleep] [--profile] [--font PATH] [--trace PATH]\n"
+				<< "                   [--frame-budget MS] [--render-scale SCALE|MIN-MAX] [--idle-pause]\n"
+				<< "                   [--pacing vsync|cap|uncapped] [--cap FPS]\n"
+				<< "       BreezyGrass --headless [--frames N] [--fps N] [--size WxH] [--format raw|png|y4m] [--output PATH|-]\n";
+			return false;
+		}
+	}
+
+	// png writes a file per frame, so its output is a name prefix and can't be stdout
+	if (headless_output.empty()) {
+		headless_output = defaultFrameOutput(headless_format);
+	}
+	else if (headless_format == eFrameFormat::PNG && headless_output == "-") {
+		std::cerr << "--output - needs --format raw or y4m; png writes one file per frame\n";
+		return false;
+	}
+
+	return true;
+}
+
+// world size of the meadow; defaults to what fits in the sim texture
+Vector2<float> meadowSize() {
+	if (meadow_size.x > 0.f && meadow_size.y > 0.f) return meadow_size;
+	return Vector2<float>{ static_cast<float>(window_size.x), static_cast<float>(window_size.y) };
+}
+
+// world area the camera shows in the sim texture
+Rect<float> viewRect() {
+	return camera.view(window_size);
+}
+
+// part of the sim texture drawn this frame; it is stretched over the whole window
+Vector2<int> renderSize() {
+	return render_scale.apply(window_size);
+}
+
 void update() {
-	// do physics
+	PROFILE_SCOPE("update");
+	{
+		PROFILE_SCOPE("wind");
+		wind_field.update(sim_time, SIM_DT);
+		trample_field.update(SIM_DT);
+	}
+	if (is_articulated) {
+		chunk_grid.step(blade_field, wind_field, trample_field, SIM_DT, job_system, [](BladeField& field, size_t begin, size_t end, float dt) {
+			articulated_blades.step(field, begin, end, dt);
+		});
+	}
+	else {
+		chunk_grid.step(blade_field, wind_field, trample_field, SIM_DT, job_system);
+	}
+	sim_time += SIM_DT;
 }
 
 
+// Rasterize blades on the CPU straight into the streaming sim texture.
+// Anything queued in the render batch is drawn over it on the backbuffer.
+int renderSoftware() {
+	PROFILE_SCOPE("render");
+
+	// only the scaled region is locked, so only that much is uploaded
+	const Vector2<int> size = renderSize();
+	SDL_Rect source{ 0, 0, size.x, size.y };
+	void* pixels = NULL;
+	int pitch = 0;
+	if (SDL_LockTexture(sim_texture, &source, &pixels, &pitch) != 0) {
+		std::cout << "Error locking sim texture: " << SDL_GetError() << "\n";
+		return RENDER_RESULT::RENDER_FAILED;
+	}
+
+	FrameTarget target{ static_cast<uint32_t*>(pixels), pitch / 4, size.x, size.y };
+	soft_rasterizer.render(target, blade_field, lod_selector.bladeRanges(), sim_alpha, job_system, camera.scaled(render_scale.scale()));
+	SDL_UnlockTexture(sim_texture);
+
+	// clumps go straight onto the backbuffer, so they are drawn at full resolution
+	SDL_RenderCopy(renderer, sim_texture, &source, &sim_rect);
+	lod_renderer.drawClumps(renderer, chunk_grid, blade_field, lod_selector, sim_alpha, camera.scaled(static_cast<float>(sim_rect.w) / window_size.x));
+
+	if (!flushRenderBatch()) {
+		return RENDER_RESULT::RENDER_FAILED;
+	}
+
+	profiler_overlay.render(renderer, profiler);
+
+	return RENDER_RESULT::RENDER_SUCCESS;
+}
+
 // Render the Game
 int render() {
-	if (!is_active) RENDER_RESULT::RENDER_SUCCESS;
+	if (!is_active) return RENDER_RESULT::RENDER_SUCCESS;
 
-	SDL_SetRenderDrawColor(renderer, 26, 26, 32, 255);
+	draw_state.setColor(renderer, RGBA{ 26, 26, 32, 255 });
 	SDL_RenderClear(renderer);
 
-	// draw border
-	SDL_SetRenderTarget(renderer, sim_texture);
-
 	if (!sim_texture) {
-		sim_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, window_size.x, window_size.y);
+		int access = render_mode == eRenderMode::SOFTWARE ? SDL_TEXTUREACCESS_STREAMING : SDL_TEXTUREACCESS_TARGET;
+		sim_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, access, window_size.x, window_size.y);
 		if (!sim_texture) {
 			std::cout << "Error creating sim texture: " << SDL_GetError() << "\n";
 			return RENDER_RESULT::RENDER_FAILED;
 		}
 	}
 
-	// draw to the texture
+	if (render_mode == eRenderMode::SOFTWARE) {
+		return renderSoftware();
+	}
+
+	PROFILE_SCOPE("render");
+
+	// draw to the scaled region of the texture
+	const Vector2<int> size = renderSize();
+	const Camera view = camera.scaled(render_scale.scale());
+	SDL_Rect source{ 0, 0, size.x, size.y };
 	SDL_SetRenderTarget(renderer, sim_texture);
+	SDL_RenderSetClipRect(renderer, &source);
 
 	// fill surface with black
-	SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-	SDL_RenderFillRect(renderer, NULL);
+	draw_state.setColor(renderer, RGBA{ 0, 0, 0, SDL_ALPHA_OPAQUE });
+	SDL_RenderFillRect(renderer, &source);
+
+	// distant chunks as clumps straight away, blades of the chunks in view at their LOD tier
+	lod_renderer.drawClumps(renderer, chunk_grid, blade_field, lod_selector, sim_alpha, view);
+	lod_renderer.queueBlades(render_batch, blade_field, lod_selector, sim_alpha, view);
 
 	// renderCircle(screen_coords, star_radius_large, star->GetColour(), 4);
 
@@ -125,8 +544,16 @@ int render() {
 		renderLine(Vector2{ 0, y }, Vector2{ ceiling_size.x, y }, RGB{ 100, 100, 160 });
 	}*/
 
-	SDL_RenderCopy(renderer, sim_texture, NULL, &sim_rect);
-	SDL_RenderPresent(renderer);
+	// submit everything queued for the texture
+	if (!flushRenderBatch()) {
+		return RENDER_RESULT::RENDER_FAILED;
+	}
+
+	// back to the window
+	SDL_RenderSetClipRect(renderer, NULL);
+	SDL_SetRenderTarget(renderer, NULL);
+	SDL_RenderCopy(renderer, sim_texture, &source, &sim_rect);
+	profiler_overlay.render(renderer, profiler);
 
 	return RENDER_RESULT::RENDER_SUCCESS;
 }
@@ -143,6 +570,30 @@ void handleEvents() {
 		case SDL_QUIT:
 			is_running = false;
 			break;
+		case SDL_KEYDOWN:
+			handleKey(event.key.keysym.sym);
+			break;
+		case SDL_MOUSEWHEEL:
+		{
+			int x, y;
+			SDL_GetMouseState(&x, &y);
+			camera.zoomAt(cursorPixels(x, y), powf(CAMERA_WHEEL_STEP, static_cast<float>(event.wheel.y)));
+			break;
+		}
+		case SDL_MOUSEBUTTONDOWN:
+			if (event.button.button == SDL_BUTTON_LEFT) {
+				trample_cursor = camera.toWorld(cursorPixels(event.button.x, event.button.y));
+				trample_field.stamp(trample_cursor, TRAMPLE_BRUSH_RADIUS, TRAMPLE_BRUSH_BEND);
+			}
+			break;
+		case SDL_MOUSEMOTION:
+			if (event.motion.state & SDL_BUTTON_LMASK) {
+				trampleTo(camera.toWorld(cursorPixels(event.motion.x, event.motion.y)));
+			}
+			else if (event.motion.state != 0) {
+				camera.pan(static_cast<float>(event.motion.xrel), static_cast<float>(event.motion.yrel));
+			}
+			break;
 		case SDL_WINDOWEVENT:
 			switch (event.window.event) {
 			case SDL_WINDOWEVENT_FOCUS_LOST:
@@ -154,6 +605,9 @@ void handleEvents() {
 				//case SDL_WINDOWEVENT_EXPOSED:
 				is_active = true;
 				break;
+			case SDL_WINDOWEVENT_SIZE_CHANGED:
+				resizeWindow(event.window.data1, event.window.data2);
+				break;
 			case SDL_WINDOWEVENT_HIDDEN:
 			case SDL_WINDOWEVENT_MINIMIZED:
 				is_active = false;
@@ -166,4 +620,74 @@ void handleEvents() {
 			break;
 		}
 	}
-}
\ No newline at end of file
+}
+
+void handleKey(SDL_Keycode key) {
+	switch (key) {
+	case SDLK_F3:
+		profiler_overlay.visible = !profiler_overlay.visible;
+		break;
+	case SDLK_F4:
+		profiler.writeTrace(trace_path.empty() ? DEFAULT_TRACE_PATH : trace_path);
+		break;
+	case SDLK_LEFT:
+		camera.pan(CAMERA_KEY_PAN, 0.f);
+		break;
+	case SDLK_RIGHT:
+		camera.pan(-CAMERA_KEY_PAN, 0.f);
+		break;
+	case SDLK_UP:
+		camera.pan(0.f, CAMERA_KEY_PAN);
+		break;
+	case SDLK_DOWN:
+		camera.pan(0.f, -CAMERA_KEY_PAN);
+		break;
+	case SDLK_HOME:
+		camera.fit(meadowSize(), window_size);
+		break;
+	default:
+		break;
+	}
+}
+
+// mouse position in sim texture pixels, which differ from the window's mid resize
+Vector2<float> cursorPixels(int x, int y) {
+	return Vector2<float>{
+		static_cast<float>(x) * window_size.x / std::max(sim_rect.w, 1),
+		static_cast<float>(y) * window_size.y / std::max(sim_rect.h, 1) };
+}
+
+// stamp along the drag from the last stamp, half a brush apart so fast strokes leave no gaps
+void trampleTo(const Vector2<float> world) {
+	const float spacing = TRAMPLE_BRUSH_RADIUS * 0.5f;
+	Vector2<float> delta = world - trample_cursor;
+	float distance = sqrtf(delta.x * delta.x + delta.y * delta.y);
+	int stamps = static_cast<int>(distance / spacing);
+	for (int i = 1; i <= stamps; i++) {
+		trample_field.stamp(trample_cursor + delta * (i * spacing / distance), TRAMPLE_BRUSH_RADIUS, TRAMPLE_BRUSH_BEND);
+	}
+	if (stamps > 0) {
+		trample_cursor = trample_cursor + delta * (stamps * spacing / distance);
+	}
+}
+
+// While the window is being dragged the old sim texture is just stretched over it;
+// the texture is only rebuilt once the size has settled for RESIZE_DEBOUNCE_MS.
+void resizeWindow(int width, int height) {
+	sim_rect = SDL_Rect{ 0, 0, width, height };
+	pending_window_size = Vector2<int>{ width, height };
+	resize_ticks = SDL_GetTicks();
+}
+
+void applyPendingResize() {
+	if (pending_window_size.x <= 0 || pending_window_size.y <= 0) return;
+	if (!SDL_TICKS_PASSED(SDL_GetTicks(), resize_ticks + RESIZE_DEBOUNCE_MS)) return;
+
+	if (pending_window_size.x != window_size.x || pending_window_size.y != window_size.y) {
+		window_size = pending_window_size;
+		// render() creates it again at the new size
+		if (sim_texture) SDL_DestroyTexture(sim_texture);
+		sim_texture = NULL;
+	}
+	pending_window_size = Vector2<int>{ 0, 0 };
+}
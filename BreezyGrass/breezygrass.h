@@ -5,25 +5,108 @@
 #include <vector>
 
 #include "types.h"
+#include "blades.h"
+#include "wind.h"
+#include "trample.h"
+#include "chunks.h"
+#include "lod.h"
+#include "verletblades.h"
+#include "camera.h"
+#include "renderscale.h"
+#include "framepacer.h"
+#include "softraster.h"
+#include "framewriter.h"
+#include "profiler.h"
 
 #define TWOPI 6.2831853071f
 inline SDL_Renderer* renderer = NULL;
 inline SDL_Window* window = NULL;
 inline int WINDOW_WIDTH = 1920;
 inline int WINDOW_HEIGHT = 1080;
-inline Vector2<int> window_size = { WINDOW_WIDTH, WINDOW_HEIGHT };
+inline Vector2<int> window_size = { WINDOW_WIDTH, WINDOW_HEIGHT }; // also the size of sim_texture
 inline SDL_Texture* sim_texture = NULL;
+constexpr Uint32 RESIZE_DEBOUNCE_MS = 200;   // quiet time after the last resize event before sim_texture is rebuilt
+inline Vector2<int> pending_window_size{ 0, 0 }; // zero when there is no resize waiting
+inline Uint32 resize_ticks = 0;
 inline bool is_active = false;
 inline bool is_running = false;
 inline bool is_fullscreen = false;
+
+// while the window is hidden or minimized the loop sleeps in SDL_WaitEventTimeout between steps
+enum class eIdleMode {
+	SIMULATE, // keep the meadow moving, every chunk at the off-screen rate
+	PAUSE     // stop the simulation until the window comes back
+};
+constexpr Uint32 IDLE_WAIT_MS = 100;
+inline eIdleMode idle_mode = eIdleMode::SIMULATE;
 inline SDL_Rect sim_rect = SDL_Rect{ 0,0,0,0 };
 
+// rendering
+enum class eRenderMode {
+	RENDERER, // SDL renderer draws into a target texture
+	SOFTWARE  // blades rasterized on the CPU into a streaming texture
+};
+inline eRenderMode render_mode = eRenderMode::RENDERER;
+inline SoftRasterizer soft_rasterizer;
+inline LodSelector lod_selector;
+inline LodRenderer lod_renderer;
+inline FramePacer frame_pacer;
+inline RenderScaleController render_scale;   // sim texture is window sized, only the top left render_scale of it is drawn
+inline Camera camera;          // right drag or arrow keys to pan, wheel to zoom, Home to see the whole meadow
+
+// profiling; F3 toggles the overlay, F4 writes a trace
+#ifdef _WIN32
+inline std::string font_path = "C:\\Windows\\Fonts\\consola.ttf";
+#else
+inline std::string font_path;
+#endif
+inline std::string trace_path;              // also written on exit when given on the command line
+constexpr const char* DEFAULT_TRACE_PATH = "breezygrass_trace.json";
+
+// headless offline rendering
+inline bool is_headless = false;
+inline int headless_frames = 300;
+inline int headless_fps = 30;
+inline eFrameFormat headless_format = eFrameFormat::RAW;
+inline std::string headless_output;           // empty picks defaultFrameOutput(headless_format)
+
+// simulation
+constexpr float SIM_DT = 1.f / 120.f;       // fixed physics step
+constexpr double MAX_FRAME_TIME = 0.25;     // longer frames are clamped so a stall can't queue up seconds of steps
+constexpr int MAX_STEPS_PER_FRAME = 8;      // beyond this the simulation slows down rather than spiralling
+inline float sim_alpha = 0.f;               // fraction of a step between the last two states, for rendering
+inline size_t blade_count = 100000;
+inline uint32_t blade_seed = 1337;
+inline BladeField blade_field;
+inline bool is_articulated = false;          // tall grass: blades made of VERLET_SEGMENTS pieces instead of one bend angle
+inline VerletBlades<VERLET_SEGMENTS> articulated_blades;
+inline WindField wind_field;
+inline TrampleField trample_field;            // left drag walks through the grass
+inline Vector2<float> trample_cursor{ 0.f, 0.f }; // world position of the last stamp while dragging
+inline ChunkGrid chunk_grid;
+inline Vector2<float> meadow_size{ 0.f, 0.f }; // world units; zero means the window size
+inline JobSystem job_system;
+inline float sim_time = 0.f;
+
 enum RENDER_RESULT {
 	RENDER_SUCCESS = 0,
 	RENDER_FAILED = 1
 };
 
-int main();
+int main(int argc, char* argv[]);
+bool parseArguments(int argc, char* argv[]);
+bool initSimulation(const Vector2<float> area);
+void shutdownSimulation();
+int runHeadless();
+Vector2<float> meadowSize();
+Rect<float> viewRect();
+Vector2<int> renderSize();
 void handleEvents();
+void handleKey(SDL_Keycode key);
+Vector2<float> cursorPixels(int x, int y);
+void trampleTo(const Vector2<float> world);
+void resizeWindow(int width, int height);
+void applyPendingResize();
 void update();
 int render();
+int renderSoftware();
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+
+#include "types.h"
+
+constexpr float CAMERA_MIN_ZOOM = 0.02f;
+constexpr float CAMERA_MAX_ZOOM = 8.f;
+constexpr float CAMERA_WHEEL_STEP = 1.15f; // zoom factor per mouse wheel notch
+constexpr float CAMERA_KEY_PAN = 64.f;     // screen pixels per arrow key press
+
+// 2D view onto the meadow: a world position at the top left of the screen and a zoom
+// in screen pixels per world unit.
+class Camera {
+public:
+	Vector2<float> position{ 0.f, 0.f };
+	float zoom = 1.f;
+
+	float toScreenX(float x) const { return (x - position.x) * zoom; }
+	float toScreenY(float y) const { return (y - position.y) * zoom; }
+	Vector2<float> toScreen(const Vector2<float> world) const { return (world - position) * zoom; }
+	Vector2<float> toWorld(const Vector2<float> screen) const { return position + screen / zoom; }
+
+	// world area covered by a screen of the given size
+	Rect<float> view(const Vector2<int> screen) const {
+		return Rect<float>{ position.x, position.y, position.x + screen.x / zoom, position.y + screen.y / zoom };
+	}
+
+	// the same view drawn into a target scale times the size of the screen
+	Camera scaled(float scale) const {
+		return Camera{ position, zoom * scale };
+	}
+
+	// drag the world by a screen space offset
+	void pan(float dx, float dy) {
+		position -= Vector2<float>{ dx, dy } / zoom;
+	}
+
+	// zoom by factor while keeping the world point under the screen point still
+	void zoomAt(const Vector2<float> screen, float factor) {
+		Vector2<float> anchor = toWorld(screen);
+		zoom = std::clamp(zoom * factor, CAMERA_MIN_ZOOM, CAMERA_MAX_ZOOM);
+		position = anchor - screen / zoom;
+	}
+
+	// the whole of area in view, centred
+	void fit(const Vector2<float> area, const Vector2<int> screen) {
+		zoom = std::clamp(std::min(screen.x / area.x, screen.y / area.y), CAMERA_MIN_ZOOM, CAMERA_MAX_ZOOM);
+		position = Vector2<float>{ area.x - screen.x / zoom, area.y - screen.y / zoom } * 0.5f;
+	}
+};
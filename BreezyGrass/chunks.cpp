@@ -0,0 +1,237 @@
+#include <math.h>
+#include <algorithm>
+
+#include "chunks.h"
+#include "wind.h"
+#include "trample.h"
+#include "profiler.h"
+
+// Counting sort of blades into their chunk, keeping seed order inside a chunk so the layout
+// only depends on the meadow. The field is rebuilt with each chunk padded to a whole number
+// of lanes, which is what lets the kernels step a chunk on its own.
+bool ChunkGrid::build(BladeField& field, const Vector2<float> area) {
+	cols = std::max(static_cast<int>(ceilf(area.x / CHUNK_SIZE)), 1);
+	rows = std::max(static_cast<int>(ceilf(area.y / CHUNK_SIZE)), 1);
+	chunks.assign(static_cast<size_t>(cols) * rows, Chunk{});
+
+	auto chunkOf = [&](size_t i) {
+		int cx = std::clamp(static_cast<int>(field.root_x[i] / CHUNK_SIZE), 0, cols - 1);
+		int cy = std::clamp(static_cast<int>(field.root_y[i] / CHUNK_SIZE), 0, rows - 1);
+		return static_cast<size_t>(cy) * cols + cx;
+	};
+
+	std::vector<size_t> counts(chunks.size(), 0);
+	for (size_t i = 0; i < field.count; i++) {
+		counts[chunkOf(i)]++;
+	}
+
+	size_t offset = 0;
+	for (size_t c = 0; c < chunks.size(); c++) {
+		Chunk& chunk = chunks[c];
+		chunk.begin = offset;
+		chunk.live_end = offset + counts[c];
+		chunk.end = offset + (counts[c] + BLADE_LANES - 1) / BLADE_LANES * BLADE_LANES;
+		offset = chunk.end;
+	}
+
+	BladeField sorted;
+	if (!sorted.allocate(offset)) {
+		return false;
+	}
+
+	std::vector<size_t> cursor(chunks.size());
+	for (size_t c = 0; c < chunks.size(); c++) {
+		cursor[c] = chunks[c].begin;
+	}
+	for (size_t i = 0; i < field.count; i++) {
+		sorted.copyBlade(field, i, cursor[chunkOf(i)]++);
+	}
+
+	for (size_t c = 0; c < chunks.size(); c++) {
+		Chunk& chunk = chunks[c];
+		const float cell_x = (c % cols) * CHUNK_SIZE;
+		const float cell_y = (c / cols) * CHUNK_SIZE;
+
+		// padding blades sit at the cell corner so they never widen the bounds
+		for (size_t i = chunk.live_end; i < chunk.end; i++) {
+			sorted.root_x[i] = cell_x;
+			sorted.root_y[i] = cell_y;
+		}
+
+		if (chunk.live_end == chunk.begin) {
+			chunk.bounds = Rect<float>{ cell_x, cell_y, cell_x, cell_y };
+			continue;
+		}
+
+		// a blade can lean its full height sideways and stand its full height up
+		Rect<float> roots{ sorted.root_x[chunk.begin], sorted.root_y[chunk.begin], sorted.root_x[chunk.begin], sorted.root_y[chunk.begin] };
+		float reach = 0.f;
+		float height_sum = 0.f;
+		for (size_t i = chunk.begin; i < chunk.live_end; i++) {
+			const float height = bladeHeight(sorted, i);
+			height_sum += height;
+			roots.left = std::min(roots.left, sorted.root_x[i]);
+			roots.right = std::max(roots.right, sorted.root_x[i]);
+			roots.top = std::min(roots.top, sorted.root_y[i]);
+			roots.bottom = std::max(roots.bottom, sorted.root_y[i]);
+			reach = std::max(reach, height + std::max(height * bladeWidthRatio(sorted, i), BLADE_MIN_WIDTH));
+		}
+		chunk.bounds = Rect<float>{ roots.left - reach, roots.top - reach, roots.right + reach, roots.bottom + reach };
+		chunk.mean_height = height_sum / (chunk.live_end - chunk.begin);
+	}
+
+	field.swap(sorted);
+
+	tick = 0;
+	updateVisibility(Rect<float>{ -INFINITY, -INFINITY, INFINITY, INFINITY });
+	return true;
+}
+
+void ChunkGrid::updateVisibility(const Rect<float>& view, float pixels_per_unit) {
+	visible_ranges.clear();
+	visible_blades = 0;
+
+	for (Chunk& chunk : chunks) {
+		chunk.visible = chunk.live_end > chunk.begin && !view.empty() && chunk.bounds.intersects(view);
+		chunk.full_rate = chunk.visible && chunk.mean_height * pixels_per_unit >= CHUNK_FULL_RATE_PIXELS;
+		if (!chunk.visible) continue;
+
+		// neighbouring chunks are adjacent in the field, so merge runs
+		if (!visible_ranges.empty() && visible_ranges.back().end == chunk.begin) {
+			visible_ranges.back().end = chunk.live_end;
+		}
+		else {
+			visible_ranges.push_back(BladeRange{ chunk.begin, chunk.live_end });
+		}
+		visible_blades += chunk.live_end - chunk.begin;
+	}
+}
+
+void ChunkGrid::step(BladeField& field, const WindField& wind, const TrampleField& trample, float dt, JobSystem& jobs) {
+	BladeKernel kernel = bladeKernel(getBladeKernel());
+	step(field, wind, trample, dt, jobs, [kernel](BladeField& blades, size_t begin, size_t end, float step_dt) {
+		kernel(blades, begin, end, BladeStepParams{ step_dt });
+	});
+}
+
+// Sample the wind and trampling and integrate every chunk that is due this tick, split across the job system.
+// Ranges only depend on visibility, the tick count and which chunks sleep, never on the number of threads.
+void ChunkGrid::step(BladeField& field, const WindField& wind, const TrampleField& trample, float dt, JobSystem& jobs, const BladeStepper& stepper) {
+	static_assert(BLADE_JOB_GRAIN % BLADE_LANES == 0, "job ranges must stay lane aligned");
+	PROFILE_SCOPE("blades");
+
+	step_ranges.clear();
+	step_slices.clear();
+	for (size_t c = 0; c < chunks.size(); c++) {
+		Chunk& chunk = chunks[c];
+		if (chunk.end == chunk.begin) continue;
+
+		const bool trampled = trample.touches(chunk.bounds);
+		if (chunk.asleep) {
+			if (!shouldWake(c, wind, trampled)) continue;
+			chunk.asleep = false;
+			chunk.quiet_time = 0.f;
+		}
+
+		chunk.pending_dt += dt;
+		if (!chunk.full_rate && (tick + c) % CHUNK_OFFSCREEN_INTERVAL != 0) continue;
+
+		for (size_t begin = chunk.begin; begin < chunk.end; begin += BLADE_JOB_GRAIN) {
+			size_t end = std::min(begin + BLADE_JOB_GRAIN, chunk.end);
+			step_slices.push_back(StepSlice{ c, begin, std::min(end, chunk.live_end), chunk.pending_dt, trampled, 0.f });
+
+			// fold small neighbouring chunks with the same step into one job
+			StepRange* last = step_ranges.empty() ? nullptr : &step_ranges.back();
+			if (last && last->end == begin && last->dt == chunk.pending_dt && end - last->begin <= BLADE_JOB_GRAIN) {
+				last->end = end;
+				last->end_slice = step_slices.size();
+			}
+			else {
+				step_ranges.push_back(StepRange{ begin, end, chunk.pending_dt, step_slices.size() - 1, step_slices.size() });
+			}
+		}
+		chunk.pending_dt = 0.f;
+	}
+	tick++;
+
+	jobs.parallelFor(step_ranges.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t r = begin; r < end; r++) {
+			const StepRange& range = step_ranges[r];
+			wind.sampleBlades(field, range.begin, range.end);
+			// only chunks the trampling reaches pay for sampling it
+			for (size_t s = range.first_slice; s < range.end_slice; s++) {
+				const StepSlice& slice = step_slices[s];
+				if (slice.trampled) {
+					trample.sampleBlades(field, slice.begin, slice.end);
+				}
+			}
+			stepper(field, range.begin, range.end, range.dt);
+
+			// each slice belongs to one range, so jobs never write the same one
+			for (size_t s = range.first_slice; s < range.end_slice; s++) {
+				StepSlice& slice = step_slices[s];
+				float peak = 0.f;
+				for (size_t i = slice.begin; i < slice.end; i++) {
+					peak = std::max(peak, field.angular_velocity[i] * field.angular_velocity[i]);
+				}
+				slice.peak_energy = peak;
+			}
+		}
+	});
+
+	// slices of a chunk are consecutive
+	for (size_t s = 0; s < step_slices.size(); s++) {
+		const StepSlice& slice = step_slices[s];
+		Chunk& chunk = chunks[slice.chunk];
+		bool first = s == 0 || step_slices[s - 1].chunk != slice.chunk;
+		chunk.peak_energy = first ? slice.peak_energy : std::max(chunk.peak_energy, slice.peak_energy);
+
+		bool last = s + 1 == step_slices.size() || step_slices[s + 1].chunk != slice.chunk;
+		if (last) {
+			settle(chunk, slice.chunk, slice.dt, wind, slice.trampled);
+		}
+	}
+}
+
+// A chunk only counts as settled while nothing is trampling it, since trampled grass is still recovering.
+void ChunkGrid::settle(Chunk& chunk, size_t c, float dt, const WindField& wind, bool trampled) {
+	bool quiet = chunk.peak_energy < CHUNK_SLEEP_SPEED * CHUNK_SLEEP_SPEED && !trampled;
+	chunk.quiet_time = quiet ? chunk.quiet_time + dt : 0.f;
+
+	if (allow_sleep && chunk.quiet_time >= CHUNK_SLEEP_TIME) {
+		chunk.asleep = true;
+		windSamples(c, wind, chunk.rest_wind);
+	}
+}
+
+bool ChunkGrid::shouldWake(size_t c, const WindField& wind, bool trampled) const {
+	const Chunk& chunk = chunks[c];
+	if (!allow_sleep || trampled) return true;
+
+	float samples[CHUNK_WAKE_SAMPLES * CHUNK_WAKE_SAMPLES];
+	windSamples(c, wind, samples);
+	for (int i = 0; i < CHUNK_WAKE_SAMPLES * CHUNK_WAKE_SAMPLES; i++) {
+		if (fabsf(samples[i] - chunk.rest_wind[i]) > CHUNK_WAKE_WIND) return true;
+	}
+	return false;
+}
+
+// the push blades get from the wind (its x component) on a small grid spanning the chunk's cell
+void ChunkGrid::windSamples(size_t c, const WindField& wind, float* out) const {
+	const float cell_x = (c % cols) * CHUNK_SIZE;
+	const float cell_y = (c / cols) * CHUNK_SIZE;
+	const float spacing = CHUNK_SIZE / (CHUNK_WAKE_SAMPLES - 1);
+	for (int y = 0; y < CHUNK_WAKE_SAMPLES; y++) {
+		for (int x = 0; x < CHUNK_WAKE_SAMPLES; x++) {
+			*out++ = wind.sample(cell_x + x * spacing, cell_y + y * spacing).x;
+		}
+	}
+}
+
+size_t ChunkGrid::sleepingChunks() const {
+	size_t count = 0;
+	for (const Chunk& chunk : chunks) {
+		count += chunk.asleep ? 1 : 0;
+	}
+	return count;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+#include "types.h"
+#include "blades.h"
+
+class WindField;
+class TrampleField;
+
+// integrates blades [begin, end) of a field by dt; both bounds are multiples of BLADE_LANES
+using BladeStepper = std::function<void(BladeField& field, size_t begin, size_t end, float dt)>;
+
+constexpr float CHUNK_SIZE = 256.f;         // world units per chunk side
+constexpr int CHUNK_OFFSCREEN_INTERVAL = 4; // steps between updates of chunks outside the view
+constexpr float CHUNK_FULL_RATE_PIXELS = 4.f; // mean on-screen blade height below which visible chunks also update slowly
+constexpr float CHUNK_SLEEP_SPEED = 0.05f;  // radians per second; a chunk whose fastest blade is slower than this is settled
+constexpr float CHUNK_SLEEP_TIME = 0.5f;    // seconds a chunk must stay settled before it sleeps
+constexpr float CHUNK_WAKE_WIND = 0.4f;     // change in wind since falling asleep that wakes a chunk, about 0.02 radians of lean
+constexpr int CHUNK_WAKE_SAMPLES = 3;       // wind samples along each side of a chunk when checking whether to wake it
+
+// A square cell of the meadow owning a contiguous, lane aligned run of blades.
+// Blades in [begin, live_end) are real; [live_end, end) is zero-height padding so the
+// next chunk starts on a lane boundary.
+struct Chunk {
+	Rect<float> bounds;  // everything any of its blades can cover, tips included
+	float mean_height = 0.f;
+	size_t begin = 0;
+	size_t live_end = 0;
+	size_t end = 0;
+	bool visible = true;
+	bool full_rate = true;  // stepped every tick rather than every CHUNK_OFFSCREEN_INTERVAL
+	float pending_dt = 0.f; // simulated time owed to an off-screen chunk
+
+	// sleeping chunks are not stepped and keep their last state until the wind or trampling near them changes
+	bool asleep = false;
+	float peak_energy = 0.f; // highest squared angular velocity of any blade after the last step
+	float quiet_time = 0.f;  // how long peak_energy has stayed below the sleep threshold
+	float rest_wind[CHUNK_WAKE_SAMPLES * CHUNK_WAKE_SAMPLES] = {}; // wind when it fell asleep
+};
+
+// Partitions the meadow into fixed size chunks.
+// Chunks that intersect the view are handed to the renderers and, unless they are zoomed out
+// so far their blades are a few pixels tall, stepped every tick. The rest catch up every
+// CHUNK_OFFSCREEN_INTERVAL ticks with the time they missed, staggered so only a fraction
+// of them is due on any one tick.
+//
+// Chunks whose blades have all come to rest go to sleep and are skipped entirely, visible or
+// not, until the wind over them drifts by CHUNK_WAKE_WIND or trampling reaches them. Their
+// blades keep their last angles, so the renderers draw them exactly as they were.
+class ChunkGrid {
+public:
+	int cols = 0;
+	int rows = 0;
+	std::vector<Chunk> chunks; // row major
+	bool allow_sleep = true;
+
+	// sort the field's blades into chunks, padding each chunk to BLADE_LANES
+	bool build(BladeField& field, const Vector2<float> area);
+	// an empty view hides every chunk, e.g. while the window is minimized
+	void updateVisibility(const Rect<float>& view, float pixels_per_unit = 1.f);
+	// steps with the active single angle blade kernel, or with stepper for other blade models
+	void step(BladeField& field, const WindField& wind, const TrampleField& trample, float dt, JobSystem& jobs);
+	void step(BladeField& field, const WindField& wind, const TrampleField& trample, float dt, JobSystem& jobs, const BladeStepper& stepper);
+
+	// live blade ranges of visible chunks, in field order
+	const std::vector<BladeRange>& visibleRanges() const { return visible_ranges; }
+	size_t visibleBlades() const { return visible_blades; }
+	size_t sleepingChunks() const;
+
+private:
+	// the live blades of one chunk inside a step range, measured after stepping
+	struct StepSlice {
+		size_t chunk;
+		size_t begin;
+		size_t end;
+		float dt;
+		bool trampled; // the chunk is within reach of trampled grass
+		float peak_energy;
+	};
+
+	struct StepRange {
+		size_t begin;
+		size_t end;
+		float dt;
+		size_t first_slice;
+		size_t end_slice;
+	};
+
+	bool shouldWake(size_t c, const WindField& wind, bool trampled) const;
+	void windSamples(size_t c, const WindField& wind, float* out) const;
+	void settle(Chunk& chunk, size_t c, float dt, const WindField& wind, bool trampled);
+
+	std::vector<BladeRange> visible_ranges;
+	size_t visible_blades = 0;
+	std::vector<StepRange> step_ranges;
+	std::vector<StepSlice> step_slices;
+	uint64_t tick = 0;
+};
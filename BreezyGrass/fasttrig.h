@@ -0,0 +1,126 @@
+#pragma once
+
+#include <math.h>
+#include <algorithm>
+#include <array>
+
+// Cheaper sin and cos for per-blade and per-vertex work.
+//
+// The polynomials are branch free (the quadrant only picks a sign), so loops calling them
+// stay vectorizable. Measured against double precision over |x| <= 1e4:
+//   fastSin, fastCos   max error 2.3e-7, a couple of float ulps near 1
+//   fastAtan2          max error 3e-7 radians
+//
+// The table holds sin at TRIG_TABLE_SIZE steps around the circle and is built at compile time:
+//   sinStep, cosStep       exact to float rounding
+//   sinLookup, cosLookup   linearly interpolated, max error 4.8e-6 within a turn either side
+//                          of zero; the index is computed in float, so keep angles small
+
+constexpr int TRIG_TABLE_SIZE = 1024; // power of two
+constexpr int TRIG_TABLE_MASK = TRIG_TABLE_SIZE - 1;
+
+namespace trig_detail {
+	constexpr double PI = 3.14159265358979323846;
+	constexpr double TAU = 2.0 * PI;
+
+	// Taylor series, converged to double precision for |x| <= pi
+	constexpr double taylorSin(double x) {
+		double term = x;
+		double sum = x;
+		for (int n = 1; n < 16; n++) {
+			term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+			sum += term;
+		}
+		return sum;
+	}
+
+	constexpr std::array<float, TRIG_TABLE_SIZE + 1> makeSinTable() {
+		std::array<float, TRIG_TABLE_SIZE + 1> table{};
+		for (int i = 0; i <= TRIG_TABLE_SIZE; i++) {
+			double angle = TAU * i / TRIG_TABLE_SIZE;
+			if (angle > PI) angle -= TAU;
+			table[i] = static_cast<float>(taylorSin(angle));
+		}
+		return table;
+	}
+
+	// pi split so k * PI_HI is exact for the k we reduce by
+	constexpr float PI_HI = 3.140625f;
+	constexpr float PI_LO = 9.67653589793e-4f;
+	constexpr float INV_PI = 0.318309886183791f;
+
+	// remove the nearest multiple of pi: x = k * pi + r with |r| <= pi / 2,
+	// returning r and the sign (-1)^k both sin and cos pick up from it
+	inline float reduce(float x, float& sign) {
+		int k = static_cast<int>(x * INV_PI + copysignf(0.5f, x));
+		float kf = static_cast<float>(k);
+		sign = 1.f - 2.f * static_cast<float>(k & 1);
+		return (x - kf * PI_HI) - kf * PI_LO;
+	}
+
+	// Taylor polynomials on [-pi/2, pi/2], truncation error below 6e-8 for sin and 7e-9 for cos
+	inline float sinPoly(float r) {
+		float r2 = r * r;
+		return r + r * r2 * (-1.f / 6.f + r2 * (1.f / 120.f + r2 * (-1.f / 5040.f + r2 * (1.f / 362880.f + r2 * (-1.f / 39916800.f)))));
+	}
+
+	// atan on [0, 1] as a * P(a^2), Abramowitz and Stegun 4.4.49
+	constexpr float ATAN_COEFFS[8] = { 0.9999993329f, -0.3332985605f, 0.1994653599f, -0.1390853351f,
+		0.0964200441f, -0.0559098861f, 0.0218612288f, -0.0040540580f };
+
+	inline float cosPoly(float r) {
+		float r2 = r * r;
+		return 1.f + r2 * (-0.5f + r2 * (1.f / 24.f + r2 * (-1.f / 720.f + r2 * (1.f / 40320.f + r2 * (-1.f / 3628800.f + r2 * (1.f / 479001600.f))))));
+	}
+}
+
+inline constexpr std::array<float, TRIG_TABLE_SIZE + 1> SIN_TABLE = trig_detail::makeSinTable();
+
+constexpr float sinStep(int step) { return SIN_TABLE[step & TRIG_TABLE_MASK]; }
+constexpr float cosStep(int step) { return SIN_TABLE[(step + TRIG_TABLE_SIZE / 4) & TRIG_TABLE_MASK]; }
+
+inline float sinLookup(float angle) {
+	float t = angle * static_cast<float>(TRIG_TABLE_SIZE / trig_detail::TAU);
+	float whole = floorf(t);
+	int i = static_cast<int>(whole) & TRIG_TABLE_MASK;
+	return SIN_TABLE[i] + (SIN_TABLE[i + 1] - SIN_TABLE[i]) * (t - whole);
+}
+
+inline float cosLookup(float angle) {
+	return sinLookup(angle + static_cast<float>(trig_detail::PI / 2.0));
+}
+
+// |x| up to about 1e4; past that the float reduction loses too much
+inline float fastSin(float x) {
+	float sign;
+	float r = trig_detail::reduce(x, sign);
+	return sign * trig_detail::sinPoly(r);
+}
+
+inline float fastCos(float x) {
+	float sign;
+	float r = trig_detail::reduce(x, sign);
+	return sign * trig_detail::cosPoly(r);
+}
+
+// atan2 without a call: a polynomial in (y/x)^2 on the first octant (Abramowitz and Stegun 4.4.49), then folded out by symmetry.
+// Both operands zero gives zero.
+inline float fastAtan2(float y, float x) {
+	float ax = fabsf(x);
+	float ay = fabsf(y);
+	float a = std::min(ax, ay) / std::max(std::max(ax, ay), 1e-30f);
+	float s = a * a;
+	const float* c = trig_detail::ATAN_COEFFS;
+	float r = a * (c[0] + s * (c[1] + s * (c[2] + s * (c[3] + s * (c[4] + s * (c[5] + s * (c[6] + s * c[7])))))));
+	r = ay > ax ? static_cast<float>(trig_detail::PI / 2.0) - r : r;
+	r = x < 0.f ? static_cast<float>(trig_detail::PI) - r : r;
+	return copysignf(r, y);
+}
+
+// one reduction for both
+inline void fastSinCos(float x, float& s, float& c) {
+	float sign;
+	float r = trig_detail::reduce(x, sign);
+	s = sign * trig_detail::sinPoly(r);
+	c = sign * trig_detail::cosPoly(r);
+}
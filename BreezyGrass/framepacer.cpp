@@ -0,0 +1,91 @@
+#include <math.h>
+#include <algorithm>
+
+#include "framepacer.h"
+#include "profiler.h"
+
+Uint32 FramePacer::rendererFlags() const {
+	return mode == ePacingMode::VSYNC ? SDL_RENDERER_PRESENTVSYNC : 0;
+}
+
+void FramePacer::framePresented() {
+	if (mode == ePacingMode::CAP && cap_fps > 0.0) {
+		waitForDeadline();
+	}
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (last_present != 0) {
+		double ms = (now - last_present) * 1000.0 / SDL_GetPerformanceFrequency();
+		if (intervals.size() < PACING_HISTORY) {
+			intervals.push_back(ms);
+		}
+		else {
+			intervals[next_interval] = ms;
+		}
+		next_interval = (next_interval + 1) % PACING_HISTORY;
+	}
+	last_present = now;
+}
+
+// Deadlines sit on a fixed grid so one slow frame doesn't shift every frame after it.
+// If we fall more than a whole period behind the grid starts again from now.
+void FramePacer::waitForDeadline() {
+	PROFILE_SCOPE("pace");
+	const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+	const Uint64 period = static_cast<Uint64>(frequency / cap_fps);
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (deadline == 0 || now > deadline + period) {
+		deadline = now + period;
+		return;
+	}
+
+	// sleep most of the way, then spin on the counter for the last stretch
+	while (deadline > now) {
+		double remaining_ms = (deadline - now) * 1000.0 / frequency;
+		if (remaining_ms <= PACING_SPIN_MS) break;
+		SDL_Delay(static_cast<Uint32>(remaining_ms - PACING_SPIN_MS));
+		now = SDL_GetPerformanceCounter();
+	}
+	while (SDL_GetPerformanceCounter() < deadline) {}
+
+	deadline += period;
+}
+
+void FramePacer::reset() {
+	deadline = 0;
+	last_present = 0;
+}
+
+PacingStats FramePacer::stats() const {
+	PacingStats result;
+	result.frames = intervals.size();
+	if (intervals.empty()) return result;
+
+	double sum = 0.0;
+	for (double ms : intervals) {
+		sum += ms;
+		result.worst_ms = std::max(result.worst_ms, ms);
+	}
+	result.mean_ms = sum / intervals.size();
+
+	double variance = 0.0;
+	for (double ms : intervals) {
+		variance += (ms - result.mean_ms) * (ms - result.mean_ms);
+	}
+	result.jitter_ms = sqrt(variance / intervals.size());
+	return result;
+}
+
+const char* pacingModeName(ePacingMode mode) {
+	switch (mode) {
+	case ePacingMode::VSYNC:
+		return "vsync";
+	case ePacingMode::CAP:
+		return "cap";
+	case ePacingMode::UNCAPPED:
+		return "uncapped";
+	default:
+		return "unknown";
+	}
+}
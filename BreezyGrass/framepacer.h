@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+enum class ePacingMode {
+	VSYNC,   // present waits for the display
+	CAP,     // we wait ourselves until the next multiple of 1 / cap_fps
+	UNCAPPED // as fast as possible, for benchmarking
+};
+
+constexpr double PACING_CAP_FPS = 60.0;
+constexpr double PACING_SPIN_MS = 1.5; // the end of a capped wait is spun, SDL_Delay can oversleep by about a millisecond
+constexpr size_t PACING_HISTORY = 240; // frame intervals kept for the jitter stats
+
+struct PacingStats {
+	size_t frames = 0;
+	double mean_ms = 0.0;
+	double jitter_ms = 0.0; // standard deviation of the interval between presents
+	double worst_ms = 0.0;
+};
+
+// Spaces out presents according to the pacing mode and keeps the recent intervals between
+// them so we can see how even the frame rate actually was.
+class FramePacer {
+public:
+	ePacingMode mode = ePacingMode::VSYNC;
+	double cap_fps = PACING_CAP_FPS;
+
+	// renderer flags the mode needs
+	Uint32 rendererFlags() const;
+
+	// call right after present: waits out the rest of the frame when capped and records the interval
+	void framePresented();
+	// forget the schedule and the last present, e.g. after the window was hidden
+	void reset();
+
+	PacingStats stats() const;
+
+private:
+	void waitForDeadline();
+
+	Uint64 deadline = 0;
+	Uint64 last_present = 0;
+	std::vector<double> intervals; // ring of PACING_HISTORY milliseconds
+	size_t next_interval = 0;
+};
+
+const char* pacingModeName(ePacingMode mode);
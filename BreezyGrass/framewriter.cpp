@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#include "SDL_image.h"
+#pragma warning(pop)
+#undef main
+
+#include "framewriter.h"
+#include "profiler.h"
+
+namespace {
+	FILE* openOutput(const std::string& path) {
+#ifdef _MSC_VER
+		FILE* file = nullptr;
+		if (fopen_s(&file, path.c_str(), "wb") != 0) return nullptr;
+		return file;
+#else
+		return fopen(path.c_str(), "wb");
+#endif
+	}
+
+	inline uint8_t clampByte(int v) {
+		return static_cast<uint8_t>(std::clamp(v, 0, 255));
+	}
+}
+
+FrameWriter::~FrameWriter() {
+	close();
+}
+
+bool FrameWriter::open(eFrameFormat frame_format, const std::string& output, int w, int h, int fps, size_t queue_depth) {
+	close();
+
+	format = frame_format;
+	path = output;
+	frame_width = w;
+	frame_height = h;
+	frames_written = 0;
+	failed = false;
+	closing = false;
+
+	if (format != eFrameFormat::PNG) {
+		if (path == "-") {
+#ifdef _WIN32
+			_setmode(_fileno(stdout), _O_BINARY);
+#endif
+			file = stdout;
+			owns_file = false;
+		}
+		else {
+			file = openOutput(path);
+			owns_file = true;
+		}
+
+		if (!file) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not open frame output %s", path.c_str());
+			return false;
+		}
+	}
+
+	if (format == eFrameFormat::Y4M) {
+		fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", w, h, fps);
+	}
+
+	const size_t pixel_count = static_cast<size_t>(w) * h;
+	buffers.assign(std::max<size_t>(queue_depth, 1), std::vector<uint32_t>(pixel_count));
+	scratch.resize(pixel_count * 4);
+	free_buffers.clear();
+	ready_buffers.clear();
+	for (size_t i = 0; i < buffers.size(); i++) {
+		free_buffers.push_back(i);
+	}
+	acquired = SIZE_MAX;
+
+	encoder = std::thread(&FrameWriter::encoderLoop, this);
+	return true;
+}
+
+// a buffer to render the next frame into, waiting only if every buffer is still queued
+uint32_t* FrameWriter::acquireFrame() {
+	std::unique_lock<std::mutex> lock(mutex);
+	buffer_freed.wait(lock, [this] { return !free_buffers.empty(); });
+
+	acquired = free_buffers.front();
+	free_buffers.pop_front();
+	return buffers[acquired].data();
+}
+
+void FrameWriter::submitFrame() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (acquired == SIZE_MAX) return;
+		ready_buffers.push_back(acquired);
+		acquired = SIZE_MAX;
+	}
+	frame_ready.notify_one();
+}
+
+// write out everything still queued and stop the encoder; false if any frame failed to write
+bool FrameWriter::close() {
+	if (!encoder.joinable()) return !failed;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closing = true;
+	}
+	frame_ready.notify_one();
+	encoder.join();
+
+	if (file) {
+		fflush(file);
+		if (owns_file) fclose(file);
+	}
+	file = nullptr;
+	owns_file = false;
+
+	return !failed;
+}
+
+void FrameWriter::encoderLoop() {
+	while (true) {
+		size_t index;
+		int frame_number;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			frame_ready.wait(lock, [this] { return !ready_buffers.empty() || closing; });
+			if (ready_buffers.empty()) return;
+
+			index = ready_buffers.front();
+			ready_buffers.pop_front();
+			frame_number = frames_written++;
+		}
+
+		bool ok;
+		{
+			PROFILE_SCOPE("encode");
+			ok = writeFrame(buffers[index], frame_number);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			failed |= !ok;
+			free_buffers.push_back(index);
+		}
+		buffer_freed.notify_one();
+	}
+}
+
+bool FrameWriter::writeFrame(const std::vector<uint32_t>& pixels, int index) {
+	switch (format) {
+	case eFrameFormat::PNG: return writePNG(pixels, index);
+	case eFrameFormat::Y4M: return writeY4M(pixels);
+	default: return writeRaw(pixels);
+	}
+}
+
+// RGBA8888 keeps R in the high byte, so unpack into plain R,G,B,A byte order
+bool FrameWriter::writeRaw(const std::vector<uint32_t>& pixels) {
+	uint8_t* out = scratch.data();
+	for (uint32_t p : pixels) {
+		*out++ = static_cast<uint8_t>(p >> 24);
+		*out++ = static_cast<uint8_t>(p >> 16);
+		*out++ = static_cast<uint8_t>(p >> 8);
+		*out++ = static_cast<uint8_t>(p);
+	}
+	return fwrite(scratch.data(), 1, pixels.size() * 4, file) == pixels.size() * 4;
+}
+
+bool FrameWriter::writePNG(const std::vector<uint32_t>& pixels, int index) {
+	char name[32];
+	snprintf(name, sizeof(name), "%05d.png", index);
+	std::string file_name = path + name;
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(pixels.data()),
+		frame_width, frame_height, 32, frame_width * 4, SDL_PIXELFORMAT_RGBA8888);
+	if (!surface) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not wrap frame %d: %s", index, SDL_GetError());
+		return false;
+	}
+
+	int ret = IMG_SavePNG(surface, file_name.c_str());
+	SDL_FreeSurface(surface);
+
+	if (ret != 0) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not save %s: %s", file_name.c_str(), IMG_GetError());
+		return false;
+	}
+	return true;
+}
+
+// planar 4:4:4 with BT.601 studio range coefficients
+bool FrameWriter::writeY4M(const std::vector<uint32_t>& pixels) {
+	const size_t plane = pixels.size();
+	uint8_t* y_plane = scratch.data();
+	uint8_t* u_plane = y_plane + plane;
+	uint8_t* v_plane = u_plane + plane;
+
+	for (size_t i = 0; i < plane; i++) {
+		int r = (pixels[i] >> 24) & 0xFF;
+		int g = (pixels[i] >> 16) & 0xFF;
+		int b = (pixels[i] >> 8) & 0xFF;
+		y_plane[i] = clampByte(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		u_plane[i] = clampByte(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		v_plane[i] = clampByte(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+	}
+
+	if (fputs("FRAME\n", file) < 0) return false;
+	return fwrite(scratch.data(), 1, plane * 3, file) == plane * 3;
+}
+
+const char* defaultFrameOutput(eFrameFormat format) {
+	switch (format) {
+	case eFrameFormat::PNG:
+		return "frame_";
+	case eFrameFormat::Y4M:
+		return "frames.y4m";
+	case eFrameFormat::RAW:
+	default:
+		return "frames.rgba";
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class eFrameFormat {
+	RAW, // packed R,G,B,A bytes, every frame appended to one file
+	PNG, // one numbered PNG per frame via SDL_image
+	Y4M  // YUV4MPEG2 4:4:4 stream, ready to pipe into an encoder
+};
+
+constexpr size_t FRAME_QUEUE_DEPTH = 4;
+
+// frames.rgba, frames.y4m, or the frame_ prefix for numbered PNGs
+const char* defaultFrameOutput(eFrameFormat format);
+
+// Streams RGBA8888 frames to disk on its own thread.
+// The producer renders into a recycled buffer from acquireFrame() and hands it back with
+// submitFrame(); encoding and I/O overlap with producing the next frames, and the producer
+// only waits if the encoder falls a whole queue behind.
+class FrameWriter {
+public:
+	FrameWriter() = default;
+	~FrameWriter();
+	FrameWriter(const FrameWriter&) = delete;
+	FrameWriter& operator=(const FrameWriter&) = delete;
+
+	// output is a file for RAW and Y4M ("-" for stdout) and a path prefix for PNG
+	bool open(eFrameFormat frame_format, const std::string& output, int frame_width, int frame_height, int fps, size_t queue_depth = FRAME_QUEUE_DEPTH);
+	uint32_t* acquireFrame();
+	void submitFrame();
+	bool close();
+
+	int width() const { return frame_width; }
+	int height() const { return frame_height; }
+
+private:
+	void encoderLoop();
+	bool writeFrame(const std::vector<uint32_t>& pixels, int index);
+	bool writeRaw(const std::vector<uint32_t>& pixels);
+	bool writePNG(const std::vector<uint32_t>& pixels, int index);
+	bool writeY4M(const std::vector<uint32_t>& pixels);
+
+	eFrameFormat format = eFrameFormat::RAW;
+	std::string path;
+	int frame_width = 0;
+	int frame_height = 0;
+	FILE* file = nullptr;
+	bool owns_file = false;
+
+	std::vector<std::vector<uint32_t>> buffers;
+	std::vector<uint8_t> scratch; // converted pixels for RAW and Y4M
+	std::deque<size_t> free_buffers;
+	std::deque<size_t> ready_buffers;
+	size_t acquired = SIZE_MAX;
+	int frames_written = 0;
+	bool failed = false;
+	bool closing = false;
+
+	std::mutex mutex;
+	std::condition_variable buffer_freed;
+	std::condition_variable frame_ready;
+	std::thread encoder;
+};
@@ -1,11 +1,10 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <stdio.h>
 #include <algorithm>
 #include <memory>
 #include <iostream>
 
-#pragma once
-
 #pragma warning(push, 0)
 #include "SDL.h"
 #include "SDL_image.h"
@@ -16,169 +15,471 @@
 #include "breezygrass.h"
 #include "types.h"
 #include "graphics.h"
+#include "fasttrig.h"
 
-bool renderRect(const Vector2<int> start, const Vector2<int> size, const RGB& color) {
-	return renderRect(start, size, RGBA{ color.R, color.G, color.B, SDL_ALPHA_OPAQUE });
+namespace {
+	SDL_Color toColor(const RGBA& c) {
+		return SDL_Color{ c.R, c.G, c.B, c.A };
+	}
+
+#if !HAS_RENDER_GEOMETRY
+	// Interpolated colours are snapped to 6 bits per channel before bucketing, which keeps
+	// a gradient to a few dozen buckets instead of one per pixel.
+	RGBA quantize(float r, float g, float b, float a) {
+		auto channel = [](float v) {
+			int c = std::clamp(static_cast<int>(v + 0.5f), 0, 255) & 0xFC;
+			return static_cast<uint8_t>(c | (c >> 6));
+		};
+		return RGBA{ channel(r), channel(g), channel(b), channel(a) };
+	}
+
+	RGBA mixColor(const SDL_Color& a, const SDL_Color& b, float t) {
+		return quantize(a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t, a.a + (b.a - a.a) * t);
+	}
+
+	// one flat colour per segment: without SDL_RenderGeometry a gradient would have to be drawn pixel by pixel
+	RGBA segmentColor(const Vertex& a, const Vertex& b) {
+		const SDL_Color& c = a.color;
+		if (c.r == b.color.r && c.g == b.color.g && c.b == b.color.b && c.a == b.color.a) return RGBA{ c.r, c.g, c.b, c.a };
+		return mixColor(a.color, b.color, 0.5f);
+	}
+
+	// scan convert a triangle into one-pixel-high spans, sampling at pixel centres and
+	// colouring each span from the vertex colours at its midpoint
+	void triangleSpans(const Vertex* v, ColorBuckets<SDL_FRect>& buckets) {
+		const Vertex* p[3] = { &v[0], &v[1], &v[2] };
+		std::sort(p, p + 3, [](const Vertex* a, const Vertex* b) { return a->position.y < b->position.y; });
+
+		const SDL_FPoint& p0 = p[0]->position;
+		const SDL_FPoint& p1 = p[1]->position;
+		const SDL_FPoint& p2 = p[2]->position;
+
+		float area = (p1.y - p2.y) * (p0.x - p2.x) + (p2.x - p1.x) * (p0.y - p2.y);
+		if (area == 0.f) return;
+		float inv_area = 1.f / area;
+
+		int y_start = static_cast<int>(ceilf(p0.y - 0.5f));
+		int y_end = static_cast<int>(ceilf(p2.y - 0.5f));
+
+		for (int y = y_start; y < y_end; y++) {
+			float yc = y + 0.5f;
+
+			// long edge p0-p2 against whichever short edge spans this row
+			float x_long = p0.x + (p2.x - p0.x) * (yc - p0.y) / (p2.y - p0.y);
+
+			const SDL_FPoint& a = yc < p1.y ? p0 : p1;
+			const SDL_FPoint& b = yc < p1.y ? p1 : p2;
+			float dy = b.y - a.y;
+			float x_short = dy > 0.f ? a.x + (b.x - a.x) * (yc - a.y) / dy : a.x;
+
+			float left = ceilf(std::min(x_long, x_short) - 0.5f);
+			float right = ceilf(std::max(x_long, x_short) - 0.5f);
+			if (right <= left) continue;
+
+			// barycentric weights at the span midpoint
+			float xc = 0.5f * (left + right);
+			float w0 = ((p1.y - p2.y) * (xc - p2.x) + (p2.x - p1.x) * (yc - p2.y)) * inv_area;
+			float w1 = ((p2.y - p0.y) * (xc - p2.x) + (p0.x - p2.x) * (yc - p2.y)) * inv_area;
+			float w2 = 1.f - w0 - w1;
+
+			const SDL_Color& c0 = p[0]->color;
+			const SDL_Color& c1 = p[1]->color;
+			const SDL_Color& c2 = p[2]->color;
+			RGBA color = quantize(
+				c0.r * w0 + c1.r * w1 + c2.r * w2,
+				c0.g * w0 + c1.g * w1 + c2.g * w2,
+				c0.b * w0 + c1.b * w1 + c2.b * w2,
+				c0.a * w0 + c1.a * w1 + c2.a * w2);
+
+			buckets[color].push_back(SDL_FRect{ left, static_cast<float>(y), right - left, 1.f });
+		}
+	}
+#endif
 }
 
-bool renderRect(const Vector2<int> start, const Vector2<int> size, const RGBA& color) {
-	// Draw a rectangle
-	//---
+void DrawState::setColor(SDL_Renderer* target, const RGBA& color) {
+	if (color_valid && color == current_color) return;
+
+	SDL_SetRenderDrawColor(target, color.R, color.G, color.B, color.A);
+	current_color = color;
+	color_valid = true;
+	state_changes++;
+}
 
-	SDL_Rect rect = SDL_Rect{ start.x, start.y, size.x, size.y };
+void DrawState::setBlendMode(SDL_Renderer* target, SDL_BlendMode mode) {
+	if (blend_valid && mode == current_blend) return;
 
-	// store current colour
-	RGBA current_color{};
-	SDL_GetRenderDrawColor(renderer, &current_color.R, &current_color.G, &current_color.B, &current_color.A);
+	SDL_SetRenderDrawBlendMode(target, mode);
+	current_blend = mode;
+	blend_valid = true;
+	state_changes++;
+}
 
-	// set given colour
-	SDL_SetRenderDrawColor(renderer, color.R, color.G, color.B, color.A);
+void DrawState::invalidate() {
+	color_valid = false;
+	blend_valid = false;
+}
 
-	// draw
-	int ret = SDL_RenderDrawRect(renderer, &rect);
+void RenderBatch::clear() {
+	triangles.clear();
+	fill_rects.clear();
+	fill_runs.clear();
+	line_vertices.clear();
+	poly_points.clear();
+	poly_runs.clear();
+}
 
-	// restore original colour
-	SDL_SetRenderDrawColor(renderer, current_color.R, current_color.G, current_color.B, current_color.A);
+bool RenderBatch::empty() const {
+	return triangles.empty() && fill_rects.empty() && line_vertices.empty() && poly_points.empty();
+}
 
-	// error handling
-	if (ret != 0)
-	{
-		const char* error = SDL_GetError();
-		if (*error != '\0')
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not renderRect. SDL Error: %s at line #%d of file %s/n", error, __LINE__, __FILE__);
-			SDL_ClearError();
-		}
-		return false;
+void RenderBatch::pushRun(std::vector<Run>& runs, size_t first, size_t count, const RGBA& color) {
+	// extend the previous run when the colour hasn't changed
+	if (!runs.empty() && runs.back().color == color && runs.back().first + runs.back().count == first) {
+		runs.back().count += count;
+		return;
 	}
+	runs.push_back(Run{ first, count, color });
+}
 
-	return true;
+void RenderBatch::addLine(const Vector2<float> start, const Vector2<float> end, const RGBA& color) {
+	addLine(start, end, color, color);
 }
 
-bool renderFillRect(const Vector2<int> start, const Vector2<int> size, const RGB& color) {
-	return renderFillRect(start, size, RGBA{ color.R, color.G, color.B, SDL_ALPHA_OPAQUE });
+// With SDL_RenderGeometry a segment is a one pixel wide quad in the triangle list, squared off half a
+// pixel past each end so even a zero length segment covers its pixel. Without it (SDL 2.0.16) the
+// segment is kept and drawn as a plain line at flush, in one colour between its two.
+void RenderBatch::addLine(const Vector2<float> start, const Vector2<float> end, const RGBA& start_color, const RGBA& end_color) {
+#if HAS_RENDER_GEOMETRY
+	float dx = end.x - start.x;
+	float dy = end.y - start.y;
+	float length = sqrtf(dx * dx + dy * dy);
+	float ux = length > 1e-6f ? 0.5f * dx / length : 0.f;
+	float uy = length > 1e-6f ? 0.5f * dy / length : 0.5f;
+
+	const SDL_Color a = toColor(start_color);
+	const SDL_Color b = toColor(end_color);
+	const SDL_FPoint no_texture{ 0.f, 0.f };
+	const Vertex a_left{ SDL_FPoint{ start.x - ux - uy, start.y - uy + ux }, a, no_texture };
+	const Vertex a_right{ SDL_FPoint{ start.x - ux + uy, start.y - uy - ux }, a, no_texture };
+	const Vertex b_left{ SDL_FPoint{ end.x + ux - uy, end.y + uy + ux }, b, no_texture };
+	const Vertex b_right{ SDL_FPoint{ end.x + ux + uy, end.y + uy - ux }, b, no_texture };
+
+	Vertex* out = appendTriangles(2);
+	out[0] = a_left;
+	out[1] = a_right;
+	out[2] = b_left;
+	out[3] = a_right;
+	out[4] = b_right;
+	out[5] = b_left;
+#else
+	line_vertices.push_back(Vertex{ SDL_FPoint{ start.x, start.y }, toColor(start_color), SDL_FPoint{ 0.f, 0.f } });
+	line_vertices.push_back(Vertex{ SDL_FPoint{ end.x, end.y }, toColor(end_color), SDL_FPoint{ 0.f, 0.f } });
+#endif
 }
 
-bool renderFillRect(const Vector2<int> start, const Vector2<int> size, const RGBA& color) {
-	// Draw a rectangle
-	//---
+// polylines are kept apart, each one is a single connected SDL_RenderDrawLinesF call
+void RenderBatch::addPolyline(const SDL_FPoint* points, size_t count, const RGBA& color) {
+	if (count < 2) return;
+	poly_runs.push_back(Run{ poly_points.size(), count, color });
+	poly_points.insert(poly_points.end(), points, points + count);
+}
 
-	SDL_Rect rect = SDL_Rect{ start.x, start.y, size.x, size.y };
+void RenderBatch::addPolyline(const SDL_FPoint* points, size_t count, const Vector2<float> offset, float scale, const RGBA& color) {
+	if (count < 2) return;
+	poly_runs.push_back(Run{ poly_points.size(), count, color });
+	for (size_t i = 0; i < count; i++) {
+		poly_points.push_back(SDL_FPoint{
+			offset.x + static_cast<float>(static_cast<long>(points[i].x * scale)),
+			offset.y + static_cast<float>(static_cast<long>(points[i].y * scale)) });
+	}
+}
 
-	// store current colour
-	RGBA current_color{};
-	SDL_GetRenderDrawColor(renderer, &current_color.R, &current_color.G, &current_color.B, &current_color.A);
+void RenderBatch::addRect(const SDL_FRect& rect, const RGBA& color) {
+	SDL_FPoint outline[5] = {
+		{ rect.x, rect.y },
+		{ rect.x + rect.w - 1.f, rect.y },
+		{ rect.x + rect.w - 1.f, rect.y + rect.h - 1.f },
+		{ rect.x, rect.y + rect.h - 1.f },
+		{ rect.x, rect.y }
+	};
+	addPolyline(outline, 5, color);
+}
 
-	// set given colour
-	SDL_SetRenderDrawColor(renderer, color.R, color.G, color.B, color.A);
+void RenderBatch::addFillRect(const SDL_FRect& rect, const RGBA& color) {
+	pushRun(fill_runs, fill_rects.size(), 1, color);
+	fill_rects.push_back(rect);
+}
 
-	// draw
-	int ret = SDL_RenderFillRect(renderer, &rect);
+void RenderBatch::addTriangle(const Vertex& a, const Vertex& b, const Vertex& c) {
+	triangles.push_back(a);
+	triangles.push_back(b);
+	triangles.push_back(c);
+}
 
-	// restore original colour
-	SDL_SetRenderDrawColor(renderer, current_color.R, current_color.G, current_color.B, current_color.A);
+Vertex* RenderBatch::appendTriangles(size_t count) {
+	size_t first = triangles.size();
+	triangles.resize(first + count * 3);
+	return triangles.data() + first;
+}
 
-	// error handling
+bool RenderBatch::check(int ret, const char* what) {
+	draw_calls++;
 	if (ret != 0)
 	{
 		const char* error = SDL_GetError();
 		if (*error != '\0')
 		{
-			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not renderRect. SDL Error: %s at line #%d of file %s/n", error, __LINE__, __FILE__);
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not %s. SDL Error: %s\n", what, error);
 			SDL_ClearError();
 		}
 		return false;
 	}
-
 	return true;
 }
 
-bool renderLine(const Vector2<int> start, const Vector2<int> end, const RGB& color) {
-	RGB oldc;
+// submit everything queued this frame to the current render target and empty the batch
+bool RenderBatch::flush(SDL_Renderer* target, DrawState& state) {
+	PROFILE_SCOPE("batch flush");
+	bool ok = true;
+	draw_calls = 0;
+
+	// filled triangles
+	if (!triangles.empty()) {
+#if HAS_RENDER_GEOMETRY
+		ok &= check(SDL_RenderGeometry(target, NULL, triangles.data(), static_cast<int>(triangles.size()), NULL, 0), "RenderGeometry");
+#else
+		// no geometry API: scan convert on the CPU and fill the spans, one call per colour
+		span_buckets.clear();
+		for (size_t t = 0; t < triangles.size(); t += 3) {
+			triangleSpans(&triangles[t], span_buckets);
+		}
+		span_buckets.forEach([&](const RGBA& color, const std::vector<SDL_FRect>& spans) {
+			state.setColor(target, color);
+			ok &= check(SDL_RenderFillRectsF(target, spans.data(), static_cast<int>(spans.size())), "RenderFillRectsF");
+		});
+#endif
+	}
 
-	int ww, wh;
-	SDL_GetWindowSize(window,
-		&ww,
-		&wh);
+	// filled rects
+	for (const Run& run : fill_runs) {
+		state.setColor(target, run.color);
+		ok &= check(SDL_RenderFillRectsF(target, &fill_rects[run.first], static_cast<int>(run.count)), "RenderFillRectsF");
+	}
 
-	// Draw a line
-	//---
-	int ret = SDL_RenderDrawLine(
-		renderer, // SDL_Renderer* renderer: the renderer in which draw
-		start.x,               // int x1: x of the starting point
-		start.y,          // int y1: y of the starting point
-		end.x,                 // int x2: x of the end point
-		end.y);           // int y2: y of the end point
-
-	// error handling
-	if (ret != 0)
-	{
-		const char* error = SDL_GetError();
-		if (*error != '\0')
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not renderDrawLine. SDL Error: %s at line #%d of file %s/n", error, __LINE__, __FILE__);
-			SDL_ClearError();
+	// only filled without SDL_RenderGeometry: independent segments share no endpoints, so each is its
+	// own line, grouped by colour so the draw colour changes once per colour
+#if !HAS_RENDER_GEOMETRY
+	if (!line_vertices.empty()) {
+		line_buckets.clear();
+		for (size_t i = 0; i < line_vertices.size(); i += 2) {
+			std::vector<SDL_FPoint>& ends = line_buckets[segmentColor(line_vertices[i], line_vertices[i + 1])];
+			ends.push_back(line_vertices[i].position);
+			ends.push_back(line_vertices[i + 1].position);
+		}
+		line_buckets.forEach([&](const RGBA& color, const std::vector<SDL_FPoint>& ends) {
+			state.setColor(target, color);
+			for (size_t i = 0; i < ends.size(); i += 2) {
+				ok &= check(SDL_RenderDrawLineF(target, ends[i].x, ends[i].y, ends[i + 1].x, ends[i + 1].y), "RenderDrawLineF");
+			}
+		});
+	}
+#endif
+
+	for (const Run& run : poly_runs) {
+		state.setColor(target, run.color);
+		ok &= check(SDL_RenderDrawLinesF(target, &poly_points[run.first], static_cast<int>(run.count)), "RenderDrawLinesF");
+	}
+
+	clear();
+	return ok;
+}
+
+int fontPointSize(eFontSize size) {
+	switch (size) {
+	case eFontSize::SMALL: return 12;
+	case eFontSize::MEDIUM: return 16;
+	case eFontSize::LARGE: return 24;
+	case eFontSize::TITLE: return 48;
+	default: return 16;
+	}
+}
+
+bool FontSet::load(const std::string& path) {
+	close();
+
+	for (int i = 0; i <= static_cast<int>(eFontSize::TITLE); i++) {
+		fonts[i] = TTF_OpenFont(path.c_str(), fontPointSize(static_cast<eFontSize>(i)));
+		if (!fonts[i]) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not open font %s: %s", path.c_str(), TTF_GetError());
+			close();
+			return false;
 		}
-		return false;
 	}
 
 	return true;
 }
 
-bool renderLine(const Vector2<float> start, const Vector2<float> end, const RGB& color) {
-	RGB oldc;
+void FontSet::close() {
+	for (TTF_Font*& font : fonts) {
+		if (font) TTF_CloseFont(font);
+		font = nullptr;
+	}
+}
 
-	int ww, wh;
-	SDL_GetWindowSize(window,
-		&ww,
-		&wh);
+ProfilerOverlay::~ProfilerOverlay() {
+	release();
+}
 
-	// Draw a line
-	//---
-	int ret = SDL_RenderDrawLine(
-		renderer, // SDL_Renderer* renderer: the renderer in which draw
-		static_cast<int>(round(start.x)),               // int x1: x of the starting point
-		static_cast<int>(round(start.y)),          // int y1: y of the starting point
-		static_cast<int>(round(end.x)),                 // int x2: x of the end point
-		static_cast<int>(round(end.y)));           // int y2: y of the end point
-
-	// error handling
-	if (ret != 0)
-	{
-		const char* error = SDL_GetError();
-		if (*error != '\0')
-		{
-			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not renderDrawLine. SDL Error: %s at line #%d of file %s/n", error, __LINE__, __FILE__);
-			SDL_ClearError();
+void ProfilerOverlay::release() {
+	if (texture) SDL_DestroyTexture(texture);
+	texture = nullptr;
+}
+
+// a broken overlay hides itself rather than taking the frame down with it
+void ProfilerOverlay::render(SDL_Renderer* target, const Profiler& source) {
+	if (!visible || !font) return;
+
+	if ((source.refreshed() || !texture) && !source.stats().empty()) {
+		if (!rebuild(target, source)) {
+			visible = false;
+			return;
 		}
+	}
+
+	if (texture) SDL_RenderCopy(target, texture, NULL, &rect);
+}
+
+// one line per zone: average ms and calls per frame; zones on worker threads are summed across threads
+bool ProfilerOverlay::rebuild(SDL_Renderer* target, const Profiler& source) {
+	char line[128];
+	std::string text;
+
+	double frame_ms = source.frameMs();
+	snprintf(line, sizeof(line), "%-12s %7.2f ms %6.0f fps", "frame", frame_ms, frame_ms > 0.0 ? 1000.0 / frame_ms : 0.0);
+	text += line;
+	for (const Profiler::Stat& stat : source.stats()) {
+		snprintf(line, sizeof(line), "\n%-12s %7.2f ms %6.1f x", stat.name, stat.avg_ms, stat.avg_calls);
+		text += line;
+	}
+
+	SDL_Color color{ text_color.R, text_color.G, text_color.B, text_color.A };
+	SDL_Surface* text_surface = TTF_RenderUTF8_Blended_Wrapped(font, text.c_str(), color, 0);
+	if (!text_surface) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not render profiler text: %s", TTF_GetError());
+		return false;
+	}
+
+	const int padding = 4;
+	SDL_Surface* panel = SDL_CreateRGBSurfaceWithFormat(0, text_surface->w + padding * 2, text_surface->h + padding * 2, 32, SDL_PIXELFORMAT_RGBA32);
+	if (!panel) {
+		SDL_FreeSurface(text_surface);
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not create profiler panel: %s", SDL_GetError());
 		return false;
 	}
 
+	SDL_FillRect(panel, NULL, SDL_MapRGBA(panel->format, background.R, background.G, background.B, background.A));
+	SDL_Rect text_rect{ padding, padding, text_surface->w, text_surface->h };
+	SDL_BlitSurface(text_surface, NULL, panel, &text_rect);
+	SDL_FreeSurface(text_surface);
+
+	release();
+	texture = SDL_CreateTextureFromSurface(target, panel);
+	rect.w = panel->w;
+	rect.h = panel->h;
+	SDL_FreeSurface(panel);
+
+	if (!texture) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not create profiler texture: %s", SDL_GetError());
+		return false;
+	}
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
 	return true;
 }
 
+bool flushRenderBatch() {
+	return render_batch.flush(renderer, draw_state);
+}
+
+bool renderRect(const Vector2<int> start, const Vector2<int> size, const RGB& color) {
+	return renderRect(start, size, RGBA{ color.R, color.G, color.B, SDL_ALPHA_OPAQUE });
+}
+
+bool renderRect(const Vector2<int> start, const Vector2<int> size, const RGBA& color) {
+	// Queue a rectangle outline
+	//---
+	SDL_FRect rect = SDL_FRect{ static_cast<float>(start.x), static_cast<float>(start.y), static_cast<float>(size.x), static_cast<float>(size.y) };
+	render_batch.addRect(rect, color);
+	return true;
+}
+
+bool renderFillRect(const Vector2<int> start, const Vector2<int> size, const RGB& color) {
+	return renderFillRect(start, size, RGBA{ color.R, color.G, color.B, SDL_ALPHA_OPAQUE });
+}
+
+bool renderFillRect(const Vector2<int> start, const Vector2<int> size, const RGBA& color) {
+	// Queue a filled rectangle
+	//---
+	SDL_FRect rect = SDL_FRect{ static_cast<float>(start.x), static_cast<float>(start.y), static_cast<float>(size.x), static_cast<float>(size.y) };
+	render_batch.addFillRect(rect, color);
+	return true;
+}
+
+bool renderLine(const Vector2<int> start, const Vector2<int> end, const RGB& color) {
+	return renderLine(
+		Vector2<float>{ static_cast<float>(start.x), static_cast<float>(start.y) },
+		Vector2<float>{ static_cast<float>(end.x), static_cast<float>(end.y) },
+		color);
+}
+
+bool renderLine(const Vector2<float> start, const Vector2<float> end, const RGB& color) {
+	// Queue a line
+	//---
+	render_batch.addLine(start, end, RGBA{ color.R, color.G, color.B, SDL_ALPHA_OPAQUE });
+	return true;
+}
+
+bool renderLine(const Vector2<float> start, const Vector2<float> end, const RGB& start_color, const RGB& end_color) {
+	// Queue a line shaded from start_color to end_color
+	//---
+	render_batch.addLine(start, end,
+		RGBA{ start_color.R, start_color.G, start_color.B, SDL_ALPHA_OPAQUE },
+		RGBA{ end_color.R, end_color.G, end_color.B, SDL_ALPHA_OPAQUE });
+	return true;
+}
+
+const std::vector<SDL_FPoint>& CircleCache::get(unsigned int sides) {
+	auto found = polygons.find(sides);
+	if (found != polygons.end()) return found->second;
+
+	std::vector<SDL_FPoint>& points = polygons[sides];
+	points.resize(sides + 1);
+	for (unsigned int i = 0; i <= sides; i++) {
+		unsigned int side = i % sides;
+		// exact table entries when the side count divides the table
+		if (TRIG_TABLE_SIZE % sides == 0) {
+			int step = static_cast<int>(side * (TRIG_TABLE_SIZE / sides));
+			points[i] = SDL_FPoint{ cosStep(step), sinStep(step) };
+		}
+		else {
+			float s, c;
+			fastSinCos(TWOPI * side / sides, s, c);
+			points[i] = SDL_FPoint{ c, s };
+		}
+	}
+	return points;
+}
+
 void renderCircle(const Vector2<int> center, float radius, const RGB& color, unsigned int sides) {
 	if (sides == 0)
 	{
-		sides = static_cast<unsigned int>(round(TWOPI * radius / 2));
+		sides = std::min(static_cast<unsigned int>(round(TWOPI * radius / 2)), CIRCLE_MAX_SIDES);
 	}
+	sides = std::max(sides, 3u);
 
-	float d_a = TWOPI / sides;
-	float angle = d_a;
-
-	Vector2<int> start{ 0, 0 };
-	Vector2<int> end{ 0 , 0 };
-	end.x = static_cast<long>(radius);
-	end.y = static_cast<long>(0.0);
-	end = end + center;
-
-	for (int i = 0; i != sides; i++)
-	{
-		start = end;
-		end.x = static_cast<long>(cos(angle) * radius);
-		end.y = static_cast<long>(sin(angle) * radius);
-		end = end + center;
-		angle += d_a;
-		renderLine(start, end, color);
-	}
-}
\ No newline at end of file
+	// one closed polyline instead of a draw call per side
+	const std::vector<SDL_FPoint>& unit = circle_cache.get(sides);
+	render_batch.addPolyline(unit.data(), unit.size(),
+		Vector2<float>{ static_cast<float>(center.x), static_cast<float>(center.y) }, radius,
+		RGBA{ color.R, color.G, color.B, SDL_ALPHA_OPAQUE });
+}
@@ -1,12 +1,203 @@
 #pragma once
 
 #include <string.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#include "SDL_ttf.h"
+#pragma warning(pop)
+#undef main
+
 #include "types.h"
+#include "profiler.h"
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define HAS_RENDER_GEOMETRY 1
+using Vertex = SDL_Vertex;
+#else
+// Same layout as SDL_Vertex (SDL 2.0.18+), so the triangle buffer can go straight to
+// SDL_RenderGeometry once the bundled SDL is upgraded.
+#define HAS_RENDER_GEOMETRY 0
+struct Vertex {
+	SDL_FPoint position;
+	SDL_Color color;
+	SDL_FPoint tex_coord;
+};
+#endif
+
+// Mirrors the renderer's draw colour and blend mode so unchanged state is never re-sent.
+// Anything that changes renderer state behind its back must call invalidate().
+class DrawState {
+public:
+	void setColor(SDL_Renderer* target, const RGBA& color);
+	void setBlendMode(SDL_Renderer* target, SDL_BlendMode mode);
+	void invalidate();
+
+	size_t stateChanges() const { return state_changes; }
+
+private:
+	RGBA current_color{};
+	SDL_BlendMode current_blend = SDL_BLENDMODE_NONE;
+	bool color_valid = false;
+	bool blend_valid = false;
+	size_t state_changes = 0;
+};
+
+inline DrawState draw_state;
+
+// Primitives grouped by colour so each colour costs one state change and one draw call.
+// Buckets and their storage are recycled between frames.
+template <typename T>
+class ColorBuckets {
+public:
+	std::vector<T>& operator[](const RGBA& color) {
+		uint32_t key = (static_cast<uint32_t>(color.R) << 24) | (color.G << 16) | (color.B << 8) | color.A;
+		auto found = index.find(key);
+		if (found != index.end()) return buckets[found->second].second;
+
+		if (used == buckets.size()) buckets.emplace_back();
+		buckets[used].first = color;
+		index.emplace(key, used);
+		return buckets[used++].second;
+	}
+
+	template <typename F>
+	void forEach(F fn) {
+		for (size_t i = 0; i < used; i++) {
+			fn(buckets[i].first, buckets[i].second);
+		}
+	}
+
+	void clear() {
+		for (size_t i = 0; i < used; i++) {
+			buckets[i].second.clear();
+		}
+		index.clear();
+		used = 0;
+	}
+
+private:
+	std::unordered_map<uint32_t, size_t> index;
+	std::vector<std::pair<RGBA, std::vector<T>>> buckets;
+	size_t used = 0;
+};
+
+// Collects a frame's primitives and submits them in a handful of renderer calls.
+// Lines and triangles carry a colour per vertex; rects and polylines one colour each.
+// Without SDL_RenderGeometry a line is drawn in the colour halfway along it.
+// Primitives are drawn in layers at flush: filled triangles, filled rects, lines, then polylines.
+class RenderBatch {
+public:
+	void clear();
+
+	void addLine(const Vector2<float> start, const Vector2<float> end, const RGBA& color);
+	void addLine(const Vector2<float> start, const Vector2<float> end, const RGBA& start_color, const RGBA& end_color);
+	void addPolyline(const SDL_FPoint* points, size_t count, const RGBA& color);
+	// points scaled by scale and moved by offset on the way in, truncated to whole pixels
+	void addPolyline(const SDL_FPoint* points, size_t count, const Vector2<float> offset, float scale, const RGBA& color);
+	void addRect(const SDL_FRect& rect, const RGBA& color);
+	void addFillRect(const SDL_FRect& rect, const RGBA& color);
+	void addTriangle(const Vertex& a, const Vertex& b, const Vertex& c);
+
+	// append room for `count` triangles and return it for the caller to fill in
+	Vertex* appendTriangles(size_t count);
+
+	bool flush(SDL_Renderer* target, DrawState& state);
+
+	size_t drawCalls() const { return draw_calls; }
+	bool empty() const;
+
+private:
+	struct Run {
+		size_t first = 0;
+		size_t count = 0;
+		RGBA color;
+	};
+
+	void pushRun(std::vector<Run>& runs, size_t first, size_t count, const RGBA& color);
+	bool check(int ret, const char* what);
+
+	std::vector<Vertex> triangles;    // three vertices per triangle
+	std::vector<SDL_FRect> fill_rects;
+	std::vector<Run> fill_runs;
+	std::vector<Vertex> line_vertices; // two vertices per segment, only without SDL_RenderGeometry
+	std::vector<SDL_FPoint> poly_points;
+	std::vector<Run> poly_runs;
+
+	// scratch space reused between frames
+	ColorBuckets<SDL_FPoint> line_buckets; // segment ends, two per segment
+	ColorBuckets<SDL_FRect> span_buckets;
+
+	size_t draw_calls = 0;
+};
+
+inline RenderBatch render_batch;
+
+constexpr unsigned int CIRCLE_MAX_SIDES = 256; // automatic side counts stop here so the cache stays small
+
+// Closed unit polygons keyed by side count, built the first time a count is asked for.
+// A circle is then one scaled and translated copy of the cached points.
+class CircleCache {
+public:
+	// sides + 1 points, the last repeating the first
+	const std::vector<SDL_FPoint>& get(unsigned int sides);
+
+private:
+	std::unordered_map<unsigned int, std::vector<SDL_FPoint>> polygons;
+};
+
+inline CircleCache circle_cache;
+
+// One face opened at every eFontSize. Text is optional, so a missing font file only
+// leaves get() returning null and callers skip their text.
+class FontSet {
+public:
+	bool load(const std::string& path);
+	void close();
+	TTF_Font* get(eFontSize size) const { return fonts[static_cast<int>(size)]; }
+
+private:
+	TTF_Font* fonts[static_cast<int>(eFontSize::TITLE) + 1] = {};
+};
+
+inline FontSet fonts;
+
+int fontPointSize(eFontSize size);
+
+// Phase timings drawn in the top left corner. The text is only re-rendered when the
+// profiler refreshes its averages, so the overlay costs one texture copy most frames.
+class ProfilerOverlay {
+public:
+	~ProfilerOverlay();
+
+	void setFont(TTF_Font* overlay_font) { font = overlay_font; }
+	void render(SDL_Renderer* target, const Profiler& source);
+	void release();
+
+	bool visible = false;
+
+private:
+	bool rebuild(SDL_Renderer* target, const Profiler& source);
+
+	TTF_Font* font = nullptr;
+	SDL_Texture* texture = nullptr;
+	SDL_Rect rect{ 8, 8, 0, 0 };
+	RGBA text_color{ 230, 230, 230, 255 };
+	RGBA background{ 0, 0, 0, 160 };
+};
+
+inline ProfilerOverlay profiler_overlay;
 
 void renderCircle(const Vector2<int> center, float radius, const RGB& color, unsigned int sides);
 bool renderLine(const Vector2<float> start, const Vector2<float> end, const RGB& color);
+bool renderLine(const Vector2<float> start, const Vector2<float> end, const RGB& start_color, const RGB& end_color);
 bool renderLine(const Vector2<int> start, const Vector2<int> end, const RGB& color);
 bool renderRect(const Vector2<int> start, const Vector2<int> end, const RGB& color);
 bool renderRect(const Vector2<int> start, const Vector2<int> end, const RGBA& color);
 bool renderFillRect(const Vector2<int> start, const Vector2<int> end, const RGB& color);
-bool renderFillRect(const Vector2<int> start, const Vector2<int> end, const RGBA& color);
\ No newline at end of file
+bool renderFillRect(const Vector2<int> start, const Vector2<int> end, const RGBA& color);
+bool flushRenderBatch();
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <system_error>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#include "jobs.h"
+#include "profiler.h"
+
+JobSystem::~JobSystem() {
+	stop();
+}
+
+bool JobSystem::start(int worker_count) {
+	stop();
+
+	worker_count = std::max(worker_count, 0);
+	queues.clear();
+	for (int i = 0; i <= worker_count; i++) {
+		queues.push_back(std::make_unique<WorkQueue>());
+	}
+
+	running = true;
+	try {
+		for (int i = 1; i <= worker_count; i++) {
+			workers.emplace_back(&JobSystem::workerLoop, this, static_cast<size_t>(i));
+		}
+	}
+	catch (const std::system_error& e) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not start job worker: %s", e.what());
+		stop();
+		return false;
+	}
+
+	return true;
+}
+
+void JobSystem::stop() {
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+		running = false;
+	}
+	wake.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+}
+
+int JobSystem::threadCount() const {
+	return static_cast<int>(workers.size()) + 1;
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const RangeFunction& fn) {
+	if (count == 0) return;
+	grain = std::max<size_t>(grain, 1);
+
+	// no pool, or nothing worth splitting
+	if (workers.empty() || count <= grain) {
+		for (size_t begin = 0; begin < count; begin += grain) {
+			fn(begin, std::min(begin + grain, count));
+		}
+		return;
+	}
+
+	size_t job_count = (count + grain - 1) / grain;
+	std::atomic<size_t> remaining{ job_count };
+
+	// deal ranges round-robin so every thread starts with local work
+	for (size_t j = 0; j < job_count; j++) {
+		Job job{ &fn, j * grain, std::min((j + 1) * grain, count), &remaining };
+		WorkQueue& queue = *queues[j % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+		queued += job_count;
+	}
+	wake.notify_all();
+
+	// help out until our batch is finished
+	Job job;
+	while (remaining.load(std::memory_order_acquire) > 0) {
+		if (popOrSteal(0, job)) {
+			runJob(job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool JobSystem::popOrSteal(size_t queue_index, Job& job) {
+	{
+		WorkQueue& own = *queues[queue_index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			job = own.jobs.back();
+			own.jobs.pop_back();
+			queued--;
+			return true;
+		}
+	}
+
+	for (size_t offset = 1; offset < queues.size(); offset++) {
+		WorkQueue& victim = *queues[(queue_index + offset) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = victim.jobs.front();
+			victim.jobs.pop_front();
+			queued--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::runJob(const Job& job) {
+	PROFILE_SCOPE("job");
+	(*job.fn)(job.begin, job.end);
+	job.remaining->fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(size_t queue_index) {
+	Job job;
+	while (true) {
+		if (popOrSteal(queue_index, job)) {
+			runJob(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		wake.wait(lock, [this] { return queued.load() > 0 || !running; });
+		if (!running) return;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+// Persistent worker pool with one deque per thread.
+// Owners pop from the back of their own deque; idle threads steal from the front of others.
+// The thread calling parallelFor owns deque 0 and works alongside the pool until its batch is done.
+class JobSystem {
+public:
+	JobSystem() = default;
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	bool start(int worker_count);
+	void stop();
+	int threadCount() const;
+
+	// Run fn over [0, count) in ranges of `grain` items and block until all have finished.
+	// Range boundaries depend only on count and grain, never on the number of threads.
+	// Must not be called from inside a job.
+	void parallelFor(size_t count, size_t grain, const RangeFunction& fn);
+
+private:
+	struct Job {
+		const RangeFunction* fn = nullptr;
+		size_t begin = 0;
+		size_t end = 0;
+		std::atomic<size_t>* remaining = nullptr;
+	};
+
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	bool popOrSteal(size_t queue_index, Job& job);
+	void runJob(const Job& job);
+	void workerLoop(size_t queue_index);
+
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::mutex wake_mutex;
+	std::condition_variable wake;
+	std::atomic<size_t> queued{ 0 };
+	std::atomic<bool> running{ false };
+};
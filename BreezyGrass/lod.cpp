@@ -0,0 +1,213 @@
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <algorithm>
+
+#include "lod.h"
+#include "graphics.h"
+#include "softraster.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "fasttrig.h"
+#include "blademesh.h"
+
+namespace {
+	eLodTier finer(eLodTier lod) {
+		return lod == eLodTier::CLUMP ? eLodTier::LINE : eLodTier::CURVED;
+	}
+
+	eLodTier coarser(eLodTier lod) {
+		return lod == eLodTier::CURVED ? eLodTier::LINE : eLodTier::CLUMP;
+	}
+
+	// on-screen height a chunk has to exceed to leave this tier for a finer one
+	float upperThreshold(eLodTier lod) {
+		return (lod == eLodTier::CLUMP ? LOD_CLUMP_PIXELS : LOD_CURVED_PIXELS) * (1.f + LOD_HYSTERESIS);
+	}
+
+	// and to drop below to leave it for a coarser one
+	float lowerThreshold(eLodTier lod) {
+		return (lod == eLodTier::CURVED ? LOD_CURVED_PIXELS : LOD_CLUMP_PIXELS) * (1.f - LOD_HYSTERESIS);
+	}
+
+	// chunks come in field order, so a chunk following the last range extends it
+	void appendRange(std::vector<BladeRange>& ranges, const Chunk& chunk) {
+		if (!ranges.empty() && ranges.back().end == chunk.begin) {
+			ranges.back().end = chunk.live_end;
+		}
+		else {
+			ranges.push_back(BladeRange{ chunk.begin, chunk.live_end });
+		}
+	}
+}
+
+void LodSelector::update(const ChunkGrid& grid, float pixels_per_unit) {
+	if (tiers.size() != grid.chunks.size()) {
+		tiers.assign(grid.chunks.size(), eLodTier::LINE);
+	}
+	for (std::vector<BladeRange>& ranges : tier_ranges) {
+		ranges.clear();
+	}
+	clump_chunks.clear();
+	blade_ranges.clear();
+
+	for (size_t c = 0; c < grid.chunks.size(); c++) {
+		const Chunk& chunk = grid.chunks[c];
+		float pixels = chunk.mean_height * pixels_per_unit;
+
+		eLodTier lod = tiers[c];
+		while (lod != eLodTier::CURVED && pixels > upperThreshold(lod)) lod = finer(lod);
+		while (lod != eLodTier::CLUMP && pixels < lowerThreshold(lod)) lod = coarser(lod);
+		tiers[c] = lod;
+
+		if (!chunk.visible) continue;
+
+		if (lod == eLodTier::CLUMP) {
+			clump_chunks.push_back(c);
+			continue;
+		}
+
+		appendRange(tier_ranges[static_cast<int>(lod)], chunk);
+		appendRange(blade_ranges, chunk);
+	}
+}
+
+LodRenderer::~LodRenderer() {
+	release();
+}
+
+void LodRenderer::release() {
+	if (clump_texture) SDL_DestroyTexture(clump_texture);
+	clump_texture = nullptr;
+}
+
+bool LodRenderer::init(SDL_Renderer* target, JobSystem& jobs) {
+	release();
+
+	const int size = LOD_CLUMP_TEXTURE_SIZE;
+	const float max_height = BLADE_HEIGHT_RANGE.max;
+
+	// a strip of short blades rooted in the bottom part of the patch, leaving headroom for the tips
+	BladeField patch;
+	if (!patch.allocate(size * 2)) {
+		return false;
+	}
+	seedBlades(patch, Vector2<float>{ static_cast<float>(size), size - max_height }, 1);
+	for (size_t i = 0; i < patch.count; i++) {
+		patch.root_y[i] += max_height;
+	}
+
+	std::vector<uint32_t> pixels(static_cast<size_t>(size) * size);
+	FrameTarget frame{ pixels.data(), size, size, size };
+	SoftRasterizer rasterizer;
+	rasterizer.render(frame, patch, 1.f, jobs);
+
+	// the rasterizer clears to opaque black; make the background see-through
+	const uint32_t background = packRGBA8888(rasterizer.clear_color);
+	for (uint32_t& pixel : pixels) {
+		if (pixel == background) pixel = 0;
+	}
+
+	clump_texture = SDL_CreateTexture(target, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, size, size);
+	if (!clump_texture) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not create clump texture: %s", SDL_GetError());
+		return false;
+	}
+	SDL_UpdateTexture(clump_texture, NULL, pixels.data(), size * 4);
+	SDL_SetTextureBlendMode(clump_texture, SDL_BLENDMODE_BLEND);
+	return true;
+}
+
+void LodRenderer::queueBlades(RenderBatch& batch, const BladeField& field, const LodSelector& lod, float alpha, const Camera& camera) const {
+	queueLines(batch, field, lod.ranges(eLodTier::LINE), alpha, camera);
+	queueMeshes(batch, field, lod.ranges(eLodTier::CURVED), alpha, camera);
+}
+
+void LodRenderer::queueLines(RenderBatch& batch, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, const Camera& camera) const {
+	for (const BladeRange& range : ranges) {
+		for (size_t i = range.begin; i < range.end; i++) {
+			const BladeArchetype& archetype = bladeArchetype(field, i);
+#if HAS_RENDER_GEOMETRY
+			const RGB root = shadeColor(archetype.root_color, field.traits[i].shade);
+			const RGB tip = shadeColor(archetype.tip_color, field.traits[i].shade);
+#else
+			// the batch can only draw these lines in one colour, so pick it here rather than have it mixed per blade
+			const RGB root = shadeColor(RGB{
+				static_cast<uint8_t>((archetype.root_color.R + archetype.tip_color.R) / 2),
+				static_cast<uint8_t>((archetype.root_color.G + archetype.tip_color.G) / 2),
+				static_cast<uint8_t>((archetype.root_color.B + archetype.tip_color.B) / 2) }, field.traits[i].shade);
+			const RGB& tip = root;
+#endif
+
+			Vector2<float> start = camera.toScreen(Vector2<float>{ field.root_x[i], field.root_y[i] });
+			float s, c;
+			fastSinCos(interpolatedAngle(field, i, alpha), s, c);
+			Vector2<float> direction{ s, -c };
+			batch.addLine(start, start + direction * (bladeHeight(field, i) * camera.zoom),
+				RGBA{ root.R, root.G, root.B, SDL_ALPHA_OPAQUE }, RGBA{ tip.R, tip.G, tip.B, SDL_ALPHA_OPAQUE });
+		}
+	}
+}
+
+// the near tier is real geometry: tapered, curved blade meshes straight into the batch's triangle list
+void LodRenderer::queueMeshes(RenderBatch& batch, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, const Camera& camera) const {
+	if (articulated) {
+		size_t vertices = bladeMeshVertices(ranges, VERLET_SEGMENTS);
+		if (vertices == 0) return;
+		buildArticulatedMesh(batch.appendTriangles(vertices / 3), field, *articulated, ranges, alpha, camera);
+		return;
+	}
+
+	size_t vertices = bladeMeshVertices(ranges);
+	if (vertices == 0) return;
+	buildBladeMesh(batch.appendTriangles(vertices / 3), field, ranges, alpha, camera);
+}
+
+// Each clump chunk is a few copies of the patch texture stretched across it, shifted by the
+// average lean of a handful of its blades and faded by how dense the chunk is.
+bool LodRenderer::drawClumps(SDL_Renderer* target, const ChunkGrid& grid, const BladeField& field, const LodSelector& lod, float alpha, const Camera& camera) const {
+	if (!clump_texture || lod.clumpChunks().empty()) return true;
+	PROFILE_SCOPE("clumps");
+
+	size_t live = 0, filled = 0;
+	for (const Chunk& chunk : grid.chunks) {
+		live += chunk.live_end - chunk.begin;
+		filled += chunk.live_end > chunk.begin ? 1 : 0;
+	}
+	const float mean_blades = filled ? static_cast<float>(live) / filled : 1.f;
+
+	bool ok = true;
+	for (size_t c : lod.clumpChunks()) {
+		const Chunk& chunk = grid.chunks[c];
+		const size_t blades = chunk.live_end - chunk.begin;
+
+		float lean = 0.f;
+		const size_t stride = std::max<size_t>(blades / LOD_CLUMP_SAMPLES, 1);
+		int samples = 0;
+		for (size_t i = chunk.begin; i < chunk.live_end && samples < LOD_CLUMP_SAMPLES; i += stride, samples++) {
+			lean += interpolatedAngle(field, i, alpha);
+		}
+		lean = samples ? lean / samples : 0.f;
+
+		const float cell_x = (c % grid.cols) * CHUNK_SIZE;
+		const float cell_y = (c / grid.cols) * CHUNK_SIZE;
+		const float row_height = CHUNK_SIZE / LOD_CLUMP_ROWS;
+		const float shift = fastSin(lean) * chunk.mean_height * 0.5f;
+		const Uint8 opacity = static_cast<Uint8>(std::clamp(255.f * blades / mean_blades, 0.f, 255.f));
+
+		ok &= SDL_SetTextureAlphaMod(clump_texture, opacity) == 0;
+		for (int row = 0; row < LOD_CLUMP_ROWS; row++) {
+			float bottom = cell_y + (row + 1) * row_height;
+			SDL_FRect dst{
+				camera.toScreenX(cell_x + shift),
+				camera.toScreenY(bottom - row_height - chunk.mean_height),
+				CHUNK_SIZE * camera.zoom,
+				(row_height + chunk.mean_height) * camera.zoom };
+			ok &= SDL_RenderCopyF(target, clump_texture, NULL, &dst) == 0;
+		}
+	}
+
+	if (!ok) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not draw grass clumps: %s", SDL_GetError());
+	}
+	return ok;
+}
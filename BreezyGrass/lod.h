@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#include "types.h"
+#include "blades.h"
+#include "chunks.h"
+#include "camera.h"
+#include "verletblades.h"
+
+class RenderBatch;
+class JobSystem;
+
+enum class eLodTier {
+	CURVED, // tapered, curved blade meshes
+	LINE,   // one shaded line per blade
+	CLUMP   // the whole chunk as a few copies of a pre-rendered grass texture
+};
+
+constexpr int LOD_TIER_COUNT = 3;
+constexpr float LOD_CURVED_PIXELS = 32.f; // mean on-screen blade height at which blades become meshes
+constexpr float LOD_CLUMP_PIXELS = 4.f;   // below this chunks collapse into clumps
+constexpr float LOD_HYSTERESIS = 0.15f;   // how far past a threshold a chunk must go before it switches
+constexpr int LOD_CLUMP_ROWS = 2;         // texture copies stacked down each clump chunk
+constexpr int LOD_CLUMP_SAMPLES = 16;     // blades averaged for a clump's lean
+constexpr int LOD_CLUMP_TEXTURE_SIZE = 64;
+
+// Picks a tier per chunk from the mean on-screen height of its blades. A chunk only moves
+// once it is LOD_HYSTERESIS past a threshold, so zooming around a boundary doesn't flicker.
+class LodSelector {
+public:
+	void update(const ChunkGrid& grid, float pixels_per_unit);
+
+	eLodTier tier(size_t chunk) const { return tiers[chunk]; }
+	// live blades of visible chunks drawn at this tier, in field order
+	const std::vector<BladeRange>& ranges(eLodTier lod) const { return tier_ranges[static_cast<int>(lod)]; }
+	const std::vector<size_t>& clumpChunks() const { return clump_chunks; }
+	// every visible blade drawn individually, whatever its tier
+	const std::vector<BladeRange>& bladeRanges() const { return blade_ranges; }
+
+private:
+	std::vector<eLodTier> tiers;
+	std::vector<BladeRange> tier_ranges[LOD_TIER_COUNT];
+	std::vector<BladeRange> blade_ranges;
+	std::vector<size_t> clump_chunks;
+};
+
+// Queues the blade tiers into a render batch and draws clump chunks with SDL_RenderCopy.
+class LodRenderer {
+public:
+	// when set, near blades are drawn along their segments rather than a curve through the bend angle
+	const VerletBlades<VERLET_SEGMENTS>* articulated = nullptr;
+
+	~LodRenderer();
+
+	// the clump texture is a small patch of blades rasterized once on the CPU
+	bool init(SDL_Renderer* target, JobSystem& jobs);
+	void release();
+
+	// everything is drawn in screen space through camera
+	void queueBlades(RenderBatch& batch, const BladeField& field, const LodSelector& lod, float alpha, const Camera& camera) const;
+	void queueLines(RenderBatch& batch, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, const Camera& camera) const;
+	void queueMeshes(RenderBatch& batch, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, const Camera& camera) const;
+	bool drawClumps(SDL_Renderer* target, const ChunkGrid& grid, const BladeField& field, const LodSelector& lod, float alpha, const Camera& camera) const;
+
+private:
+	SDL_Texture* clump_texture = nullptr;
+};
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "profiler.h"
+
+namespace {
+	FILE* openTrace(const std::string& path) {
+#ifdef _MSC_VER
+		FILE* file = nullptr;
+		if (fopen_s(&file, path.c_str(), "wb") != 0) return nullptr;
+		return file;
+#else
+		return fopen(path.c_str(), "wb");
+#endif
+	}
+
+	// zone names are literals, but the same literal may have a different address per translation unit
+	bool sameName(const char* a, const char* b) {
+		return a == b || strcmp(a, b) == 0;
+	}
+}
+
+// The owner may be overwriting the oldest slots while we copy, which is why anything that is
+// not within the ring's length of the head after the copy, the slot it is filling included, is dropped again.
+void ProfileRing::collect(uint64_t since, std::vector<ProfileZone>& out) const {
+	const uint64_t h = head.load(std::memory_order_acquire);
+	const uint64_t oldest = h > PROFILE_RING_SIZE ? h - PROFILE_RING_SIZE : 0;
+	const size_t first = out.size();
+
+	for (uint64_t i = h; i > oldest; i--) {
+		const ProfileZone& zone = zones[(i - 1) & (PROFILE_RING_SIZE - 1)];
+		if (zone.end < since) break; // zones are pushed as they finish, so ends only grow
+		out.push_back(zone);
+	}
+
+	const uint64_t after = head.load(std::memory_order_acquire);
+	if (after - oldest >= PROFILE_RING_SIZE) {
+		// entries up to after - PROFILE_RING_SIZE may be torn, that last one being the slot the owner is filling now
+		const uint64_t limit = after - PROFILE_RING_SIZE + 1;
+		const uint64_t valid = h > limit ? std::min<uint64_t>(h - limit, out.size() - first) : 0;
+		out.resize(first + static_cast<size_t>(valid));
+	}
+}
+
+Profiler::Profiler() {
+	origin = SDL_GetPerformanceCounter();
+	ticks_to_ms = 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+	refresh_start = origin;
+	frame_start = origin;
+}
+
+Profiler::~Profiler() {
+	for (int i = 0; i < PROFILE_MAX_THREADS; i++) {
+		delete rings[i].load();
+	}
+}
+
+ProfileRing* Profiler::threadRing() {
+	thread_local ProfileRing* ring = nullptr;
+	thread_local bool registered = false;
+	if (registered) return ring;
+
+	registered = true;
+	int id = ring_count.fetch_add(1);
+	if (id >= PROFILE_MAX_THREADS) return nullptr;
+
+	ring = new ProfileRing(id);
+	rings[id].store(ring, std::memory_order_release);
+	return ring;
+}
+
+void Profiler::beginFrame() {
+	frame_start = now();
+}
+
+// total this frame's zones by name; every PROFILE_REFRESH the totals become per-frame averages
+void Profiler::endFrame() {
+	const uint64_t frame_end = now();
+
+	scratch.clear();
+	int count = std::min(ring_count.load(), PROFILE_MAX_THREADS);
+	for (int i = 0; i < count; i++) {
+		if (const ProfileRing* ring = rings[i].load(std::memory_order_acquire)) {
+			ring->collect(frame_start, scratch);
+		}
+	}
+
+	for (const ProfileZone& zone : scratch) {
+		auto stat = std::find_if(pending_stats.begin(), pending_stats.end(), [&](const Stat& s) { return sameName(s.name, zone.name); });
+		if (stat == pending_stats.end()) {
+			pending_stats.push_back(Stat{ zone.name });
+			stat = pending_stats.end() - 1;
+		}
+		stat->frame_ms += (zone.end - zone.start) * ticks_to_ms;
+		stat->calls++;
+	}
+
+	refresh_frames++;
+	refresh_frame_ms += (frame_end - frame_start) * ticks_to_ms;
+
+	was_refreshed = (frame_end - refresh_start) * ticks_to_ms >= PROFILE_REFRESH * 1000.0;
+	if (!was_refreshed) return;
+
+	shown_frame_ms = refresh_frame_ms / refresh_frames;
+	shown_stats.clear();
+	for (Stat& stat : pending_stats) {
+		if (stat.calls > 0) {
+			Stat shown{ stat.name };
+			shown.avg_ms = stat.frame_ms / refresh_frames;
+			shown.avg_calls = static_cast<double>(stat.calls) / refresh_frames;
+			shown_stats.push_back(shown);
+		}
+		stat.frame_ms = 0.0;
+		stat.calls = 0;
+	}
+	std::sort(shown_stats.begin(), shown_stats.end(), [](const Stat& a, const Stat& b) { return a.avg_ms > b.avg_ms; });
+
+	refresh_start = frame_end;
+	refresh_frames = 0;
+	refresh_frame_ms = 0.0;
+}
+
+// Chrome trace event format: one complete ("X") event per zone, timestamps in microseconds
+bool Profiler::writeTrace(const std::string& path) const {
+	FILE* file = openTrace(path);
+	if (!file) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not open trace file %s", path.c_str());
+		return false;
+	}
+
+	std::vector<ProfileZone> zones;
+	const double ticks_to_us = ticks_to_ms * 1000.0;
+	bool first = true;
+
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+	int count = std::min(ring_count.load(), PROFILE_MAX_THREADS);
+	for (int i = 0; i < count; i++) {
+		const ProfileRing* ring = rings[i].load(std::memory_order_acquire);
+		if (!ring) continue;
+
+		zones.clear();
+		ring->collect(0, zones);
+		for (auto zone = zones.rbegin(); zone != zones.rend(); ++zone) {
+			fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				first ? "" : ",\n", zone->name, ring->threadId(),
+				(zone->start - origin) * ticks_to_us, (zone->end - zone->start) * ticks_to_us);
+			first = false;
+		}
+	}
+	fputs("\n]}\n", file);
+
+	bool ok = ferror(file) == 0;
+	fclose(file);
+	return ok;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+constexpr size_t PROFILE_RING_SIZE = 1 << 14;  // zones kept per thread, power of two
+constexpr int PROFILE_MAX_THREADS = 64;
+constexpr double PROFILE_REFRESH = 0.25;      // seconds between refreshes of the averaged stats
+
+struct ProfileZone {
+	const char* name = nullptr; // string literal, compared by address
+	uint64_t start = 0;
+	uint64_t end = 0;
+};
+
+// Single-writer ring of finished zones. Only the owning thread pushes; readers copy a
+// range and then re-check the head to throw away anything overwritten while copying.
+class ProfileRing {
+public:
+	explicit ProfileRing(int thread_id) : id(thread_id) {}
+
+	void push(const char* name, uint64_t start, uint64_t end) {
+		uint64_t h = head.load(std::memory_order_relaxed);
+		ProfileZone& zone = zones[h & (PROFILE_RING_SIZE - 1)];
+		zone.name = name;
+		zone.start = start;
+		zone.end = end;
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	// newest-first copy of zones that finished at or after `since`
+	void collect(uint64_t since, std::vector<ProfileZone>& out) const;
+
+	int threadId() const { return id; }
+
+private:
+	const int id;
+	std::atomic<uint64_t> head{ 0 };
+	ProfileZone zones[PROFILE_RING_SIZE];
+};
+
+// Frame-time profiler. Scoped zones from any thread land in that thread's ring without
+// locking; once per frame the main thread totals the frame's zones by name for the overlay,
+// and on request the rings are written out as a Chrome trace (chrome://tracing, Perfetto).
+class Profiler {
+public:
+	struct Stat {
+		const char* name = nullptr;
+		double frame_ms = 0.0; // summed over the refresh period, divided on refresh
+		int calls = 0;
+		double avg_ms = 0.0;   // per frame, as last shown
+		double avg_calls = 0.0;
+	};
+
+	Profiler();
+	~Profiler();
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	// the calling thread's ring, created on first use; null once PROFILE_MAX_THREADS are taken
+	ProfileRing* threadRing();
+	uint64_t now() const { return SDL_GetPerformanceCounter(); }
+
+	void beginFrame();
+	void endFrame();
+
+	const std::vector<Stat>& stats() const { return shown_stats; }
+	double frameMs() const { return shown_frame_ms; }
+	bool refreshed() const { return was_refreshed; }
+
+	bool writeTrace(const std::string& path) const;
+
+private:
+	std::atomic<ProfileRing*> rings[PROFILE_MAX_THREADS] = {};
+	std::atomic<int> ring_count{ 0 };
+	uint64_t origin = 0;
+	double ticks_to_ms = 0.0;
+
+	uint64_t frame_start = 0;
+	uint64_t refresh_start = 0;
+	int refresh_frames = 0;
+	double refresh_frame_ms = 0.0;
+	bool was_refreshed = false;
+	std::vector<Stat> pending_stats;
+	std::vector<Stat> shown_stats;
+	double shown_frame_ms = 0.0;
+	std::vector<ProfileZone> scratch;
+};
+
+inline Profiler profiler;
+
+class ProfileScope {
+public:
+	explicit ProfileScope(const char* zone_name) : name(zone_name), start(SDL_GetPerformanceCounter()) {}
+	~ProfileScope() {
+		uint64_t end = SDL_GetPerformanceCounter();
+		if (ProfileRing* ring = profiler.threadRing()) {
+			ring->push(name, start, end);
+		}
+	}
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* name;
+	uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
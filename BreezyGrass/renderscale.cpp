@@ -0,0 +1,34 @@
+#include <algorithm>
+
+#include "renderscale.h"
+
+void RenderScaleController::reset(float scale) {
+	current = std::clamp(scale, min_scale, max_scale);
+	average_ms = 0.0;
+	frames = 0;
+}
+
+void RenderScaleController::update(double render_ms) {
+	if (budget_ms <= 0.0) return;
+
+	average_ms = frames == 0 ? render_ms : average_ms + (render_ms - average_ms) * RENDER_SCALE_SMOOTHING;
+	if (++frames < RENDER_SCALE_COOLDOWN) return;
+
+	float next = current;
+	if (average_ms > budget_ms) {
+		next = std::max(current - RENDER_SCALE_STEP, min_scale);
+	}
+	else if (average_ms < budget_ms * RENDER_SCALE_HEADROOM) {
+		next = std::min(current + RENDER_SCALE_STEP, max_scale);
+	}
+
+	if (next != current) {
+		reset(next);
+	}
+}
+
+Vector2<int> RenderScaleController::apply(const Vector2<int> size) const {
+	return Vector2<int>{
+		std::max(static_cast<int>(size.x * current + 0.5f), 1),
+		std::max(static_cast<int>(size.y * current + 0.5f), 1) };
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "types.h"
+
+constexpr float RENDER_SCALE_MIN = 0.5f;        // lowest fraction of the window resolution we render at
+constexpr float RENDER_SCALE_MAX = 1.f;
+constexpr float RENDER_SCALE_STEP = 0.05f;
+constexpr double RENDER_SCALE_BUDGET_MS = 1000.0 / 60.0;
+constexpr double RENDER_SCALE_SMOOTHING = 0.1;  // weight of the newest frame in the running average
+constexpr double RENDER_SCALE_HEADROOM = 0.8;   // only scale back up once this far under budget
+constexpr int RENDER_SCALE_COOLDOWN = 20;       // frames to let a change settle before judging it
+
+// Picks the fraction of the window resolution the sim texture is drawn at, stepping it down
+// while drawing a frame takes longer than the budget and back up once there is room again.
+// The average is reset after every change so each step is judged on its own frames.
+class RenderScaleController {
+public:
+	double budget_ms = RENDER_SCALE_BUDGET_MS; // zero keeps the scale where it is
+	float min_scale = RENDER_SCALE_MIN;
+	float max_scale = RENDER_SCALE_MAX;
+
+	// time spent drawing the frame, the only part of it the scale changes
+	void update(double render_ms);
+	void reset(float scale);
+
+	float scale() const { return current; }
+	double averageMs() const { return average_ms; }
+	// size of the region of a full size target that is drawn into
+	Vector2<int> apply(const Vector2<int> size) const;
+
+private:
+	float current = RENDER_SCALE_MAX;
+	double average_ms = 0.0;
+	int frames = 0;
+};
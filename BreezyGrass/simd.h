@@ -0,0 +1,37 @@
+#pragma once
+
+// x86 vector support. MSVC lets any function use any intrinsic, while GCC and Clang need
+// the wider instruction sets enabled per function; the runtime dispatchers make sure a
+// function is only ever called on a CPU that reports the matching SDL_Has* feature.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+#if SIMD_X86 && !defined(_MSC_VER)
+#define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SIMD_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define SIMD_TARGET_SSE2
+#define SIMD_TARGET_AVX2
+#define SIMD_TARGET_AVX512
+#endif
+
+enum class eSimdLevel {
+	SCALAR,
+	SSE2,
+	AVX2,
+	AVX512
+};
+
+inline const char* simdLevelName(eSimdLevel level) {
+	switch (level) {
+	case eSimdLevel::SSE2: return "SSE2";
+	case eSimdLevel::AVX2: return "AVX2";
+	case eSimdLevel::AVX512: return "AVX-512";
+	default: return "scalar";
+	}
+}
@@ -0,0 +1,251 @@
+#include <math.h>
+#include <algorithm>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#include "softraster.h"
+#include "blades.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "fasttrig.h"
+
+namespace {
+	struct Triangle {
+		float x[3];
+		float y[3];
+		float root_y;
+		float inv_rise; // 1 / (root_y - tip_y), for the root-to-tip gradient
+	};
+
+	// tapered blade in screen space: two root corners either side of the stem and the tip.
+	// the minimum width is in pixels so far away blades still cover something
+	inline Triangle bladeTriangle(const BladeField& field, size_t i, float alpha, const Camera& camera) {
+		float angle = interpolatedAngle(field, i, alpha);
+		float s, c;
+		fastSinCos(angle, s, c);
+		float h = bladeHeight(field, i) * camera.zoom;
+		float half_width = 0.5f * std::max(h * bladeWidthRatio(field, i), BLADE_MIN_WIDTH);
+		float rx = camera.toScreenX(field.root_x[i]);
+		float ry = camera.toScreenY(field.root_y[i]);
+
+		Triangle tri;
+		tri.x[0] = rx - c * half_width;
+		tri.y[0] = ry - s * half_width;
+		tri.x[1] = rx + c * half_width;
+		tri.y[1] = ry + s * half_width;
+		tri.x[2] = rx + s * h;
+		tri.y[2] = ry - c * h;
+		tri.root_y = ry;
+		tri.inv_rise = 1.f / std::max(ry - tri.y[2], 1.f);
+		return tri;
+	}
+
+	// first pixel whose centre lies at or past x, i.e. floor(x + 0.5); the offset keeps the
+	// truncating conversion a floor for anything a little off screen, without a libm call
+	inline int pixelEdge(float x) {
+		return static_cast<int>(x + 65536.5f) - 65536;
+	}
+
+	using SpanFill = void (*)(uint32_t* dst, int count, uint32_t color);
+
+	void fillScalar(uint32_t* dst, int count, uint32_t color) {
+		for (int i = 0; i < count; i++) {
+			dst[i] = color;
+		}
+	}
+
+#if SIMD_X86
+	SIMD_TARGET_SSE2
+	void fillSSE2(uint32_t* dst, int count, uint32_t color) {
+		const __m128i c = _mm_set1_epi32(static_cast<int>(color));
+		int i = 0;
+		for (; i + 4 <= count; i += 4) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), c);
+		}
+		for (; i < count; i++) {
+			dst[i] = color;
+		}
+	}
+
+	SIMD_TARGET_AVX2
+	void fillAVX2(uint32_t* dst, int count, uint32_t color) {
+		const __m256i c = _mm256_set1_epi32(static_cast<int>(color));
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), c);
+		}
+		for (; i < count; i++) {
+			dst[i] = color;
+		}
+	}
+#endif
+
+	SpanFill pickSpanFill() {
+#if SIMD_X86
+		if (SDL_HasAVX2()) return fillAVX2;
+		if (SDL_HasSSE2()) return fillSSE2;
+#endif
+		return fillScalar;
+	}
+
+	const SpanFill fill_span = pickSpanFill();
+}
+
+void SoftRasterizer::render(const FrameTarget& target, const BladeField& field, float alpha, JobSystem& jobs, const Camera& camera) {
+	all_blades.assign(1, BladeRange{ 0, field.count });
+	render(target, field, all_blades, alpha, jobs, camera);
+}
+
+void SoftRasterizer::render(const FrameTarget& target, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, JobSystem& jobs, const Camera& camera) {
+	if (!target.pixels || target.width <= 0 || target.height <= 0) return;
+
+	view = camera;
+	tiles_x = (target.width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	tiles_y = (target.height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+
+	// root to tip colour ramps, each shade level taking the shade in the middle of its band
+	for (size_t a = 0; a < BLADE_ARCHETYPE_COUNT; a++) {
+		for (int level = 0; level < RASTER_SHADE_LEVELS; level++) {
+			const uint8_t shade = static_cast<uint8_t>((2 * level + 1) * 128 / RASTER_SHADE_LEVELS);
+			const RGB root_color = shadeColor(BLADE_ARCHETYPES[a].root_color, shade);
+			const RGB tip_color = shadeColor(BLADE_ARCHETYPES[a].tip_color, shade);
+			uint32_t* gradient = gradients[a * RASTER_SHADE_LEVELS + level];
+			for (int i = 0; i < 256; i++) {
+				float t = i / 255.f;
+				gradient[i] = packRGBA8888(RGB{
+					static_cast<uint8_t>(root_color.R + (tip_color.R - root_color.R) * t),
+					static_cast<uint8_t>(root_color.G + (tip_color.G - root_color.G) * t),
+					static_cast<uint8_t>(root_color.B + (tip_color.B - root_color.B) * t) });
+			}
+		}
+	}
+
+	{
+		PROFILE_SCOPE("raster bin");
+		bin(target, field, ranges, alpha, jobs);
+	}
+
+	PROFILE_SCOPE("raster tiles");
+	jobs.parallelFor(static_cast<size_t>(tiles_x) * tiles_y, 1, [&](size_t begin, size_t end) {
+		for (size_t tile = begin; tile < end; tile++) {
+			rasterizeTile(target, field, alpha, static_cast<int>(tile));
+		}
+	});
+}
+
+// sort blade indices into the tiles their triangles touch; each job owns its own set of bins
+void SoftRasterizer::bin(const FrameTarget& target, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, JobSystem& jobs) {
+	const size_t tile_count = static_cast<size_t>(tiles_x) * tiles_y;
+
+	// cut big ranges and group small ones so each job bins roughly RASTER_BIN_GRAIN blades
+	pieces.clear();
+	size_t total = 0;
+	for (const BladeRange& range : ranges) {
+		for (size_t begin = range.begin; begin < range.end; begin += RASTER_BIN_GRAIN) {
+			pieces.push_back(BladeRange{ begin, std::min(begin + RASTER_BIN_GRAIN, range.end) });
+		}
+		total += range.end - range.begin;
+	}
+	const size_t pieces_per_job = pieces.empty() ? 1 : std::max<size_t>(RASTER_BIN_GRAIN * pieces.size() / std::max<size_t>(total, 1), 1);
+	bin_jobs = std::max<size_t>((pieces.size() + pieces_per_job - 1) / pieces_per_job, 1);
+
+	bins.resize(bin_jobs * tile_count);
+	for (std::vector<uint32_t>& tile_bin : bins) {
+		tile_bin.clear();
+	}
+
+	const float max_x = static_cast<float>(target.width - 1);
+	const float max_y = static_cast<float>(target.height - 1);
+
+	jobs.parallelFor(pieces.size(), pieces_per_job, [&](size_t first, size_t last) {
+		std::vector<uint32_t>* job_bins = &bins[first / pieces_per_job * tile_count];
+
+		for (size_t piece = first; piece < last; piece++) {
+			for (size_t i = pieces[piece].begin; i < pieces[piece].end; i++) {
+				Triangle tri = bladeTriangle(field, i, alpha, view);
+				float min_x = std::min({ tri.x[0], tri.x[1], tri.x[2] });
+				float max_tx = std::max({ tri.x[0], tri.x[1], tri.x[2] });
+				float min_y = std::min({ tri.y[0], tri.y[1], tri.y[2] });
+				float max_ty = std::max({ tri.y[0], tri.y[1], tri.y[2] });
+
+				if (max_tx < 0.f || max_ty < 0.f || min_x > max_x || min_y > max_y) continue;
+
+				int tx0 = static_cast<int>(std::max(min_x, 0.f)) / RASTER_TILE_SIZE;
+				int tx1 = static_cast<int>(std::min(max_tx, max_x)) / RASTER_TILE_SIZE;
+				int ty0 = static_cast<int>(std::max(min_y, 0.f)) / RASTER_TILE_SIZE;
+				int ty1 = static_cast<int>(std::min(max_ty, max_y)) / RASTER_TILE_SIZE;
+
+				for (int ty = ty0; ty <= ty1; ty++) {
+					for (int tx = tx0; tx <= tx1; tx++) {
+						job_bins[ty * tiles_x + tx].push_back(static_cast<uint32_t>(i));
+					}
+				}
+			}
+		}
+	});
+}
+
+// clear one tile and fill every binned blade's spans inside it
+void SoftRasterizer::rasterizeTile(const FrameTarget& target, const BladeField& field, float alpha, int tile) {
+	const int x0 = (tile % tiles_x) * RASTER_TILE_SIZE;
+	const int y0 = (tile / tiles_x) * RASTER_TILE_SIZE;
+	const int x1 = std::min(x0 + RASTER_TILE_SIZE, target.width);
+	const int y1 = std::min(y0 + RASTER_TILE_SIZE, target.height);
+	const size_t tile_count = static_cast<size_t>(tiles_x) * tiles_y;
+
+	const uint32_t background = packRGBA8888(clear_color);
+	for (int y = y0; y < y1; y++) {
+		fill_span(target.pixels + static_cast<size_t>(y) * target.pitch + x0, x1 - x0, background);
+	}
+
+	// earlier bin jobs hold lower blade indices, so draw order matches the single threaded order
+	for (size_t job = 0; job < bin_jobs; job++) {
+		for (uint32_t i : bins[job * tile_count + tile]) {
+			Triangle tri = bladeTriangle(field, i, alpha, view);
+			const BladeTraits traits = field.traits[i];
+			const uint32_t* gradient = gradients[traits.archetype * RASTER_SHADE_LEVELS + traits.shade * RASTER_SHADE_LEVELS / 256];
+
+			int order[3] = { 0, 1, 2 };
+			std::sort(order, order + 3, [&](int a, int b) { return tri.y[a] < tri.y[b]; });
+			const float ax = tri.x[order[0]], ay = tri.y[order[0]];
+			const float bx = tri.x[order[1]], by = tri.y[order[1]];
+			const float cx = tri.x[order[2]], cy = tri.y[order[2]];
+			if (cy - ay <= 0.f) continue;
+
+			int row_start = std::max(pixelEdge(ay), y0);
+			int row_end = std::min(pixelEdge(cy), y1);
+
+			// edge slopes once per triangle rather than per row
+			const float slope_ac = (cx - ax) / (cy - ay);
+			const float slope_ab = by > ay ? (bx - ax) / (by - ay) : 0.f;
+			const float slope_bc = cy > by ? (cx - bx) / (cy - by) : 0.f;
+
+			for (int y = row_start; y < row_end; y++) {
+				float yc = y + 0.5f;
+
+				// long edge a-c against whichever short edge spans this row
+				float x_long = ax + slope_ac * (yc - ay);
+				float x_short = yc < by ? ax + slope_ab * (yc - ay) : bx + slope_bc * (yc - by);
+
+				int left = std::max(pixelEdge(std::min(x_long, x_short)), x0);
+				int right = std::min(pixelEdge(std::max(x_long, x_short)), x1);
+				if (right <= left) continue;
+
+				float t = std::clamp((tri.root_y - yc) * tri.inv_rise, 0.f, 1.f);
+				uint32_t color = gradient[static_cast<int>(t * 255.f)];
+				uint32_t* row = target.pixels + static_cast<size_t>(y) * target.pitch;
+
+				// most blade spans are a few pixels wide; only wide ones are worth the vector call
+				if (right - left < 8) {
+					for (int x = left; x < right; x++) row[x] = color;
+				}
+				else {
+					fill_span(row + left, right - left, color);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "types.h"
+#include "simd.h"
+#include "blades.h"
+#include "camera.h"
+
+constexpr int RASTER_TILE_SIZE = 64;            // pixels per tile side
+constexpr size_t RASTER_BIN_GRAIN = 256 * 1024; // blades binned per job
+constexpr int RASTER_SHADE_LEVELS = 4;          // blade shades are rounded to this many colour ramps per archetype
+
+// A block of RGBA8888 pixels owned by someone else (a locked texture, a surface, a frame buffer).
+struct FrameTarget {
+	uint32_t* pixels = nullptr;
+	int pitch = 0; // in pixels
+	int width = 0;
+	int height = 0;
+};
+
+inline uint32_t packRGBA8888(const RGB& color) {
+	return (static_cast<uint32_t>(color.R) << 24) | (color.G << 16) | (color.B << 8) | 0xFFu;
+}
+
+// Draws blades as tapered triangles straight into a pixel buffer on the CPU.
+// Blades are first binned into screen tiles in parallel, then every tile is cleared and
+// filled by a single job, so threads never write the same pixels and scaling is predictable.
+class SoftRasterizer {
+public:
+	RGB clear_color{ 0, 0, 0 };
+
+	// every blade in the field, or only the given ranges (e.g. the visible chunks), seen through camera
+	void render(const FrameTarget& target, const BladeField& field, float alpha, JobSystem& jobs, const Camera& camera = Camera{});
+	void render(const FrameTarget& target, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, JobSystem& jobs, const Camera& camera = Camera{});
+
+private:
+	void bin(const FrameTarget& target, const BladeField& field, const std::vector<BladeRange>& ranges, float alpha, JobSystem& jobs);
+	void rasterizeTile(const FrameTarget& target, const BladeField& field, float alpha, int tile);
+
+	Camera view;
+	int tiles_x = 0;
+	int tiles_y = 0;
+	size_t bin_jobs = 0;
+	std::vector<BladeRange> all_blades;
+	std::vector<BladeRange> pieces;          // ranges cut to at most RASTER_BIN_GRAIN blades
+	std::vector<std::vector<uint32_t>> bins; // [bin_job * tile_count + tile] -> blade indices
+	uint32_t gradients[BLADE_ARCHETYPE_COUNT * RASTER_SHADE_LEVELS][256] = {}; // root to tip, per archetype and shade
+};
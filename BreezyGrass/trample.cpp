@@ -0,0 +1,152 @@
+#include <math.h>
+#include <algorithm>
+
+#include "trample.h"
+#include "blades.h"
+
+namespace {
+	inline float lerp(float a, float b, float t) {
+		return a + (b - a) * t;
+	}
+}
+
+void TrampleField::init(const Vector2<float> area, float cell) {
+	cell_size = cell;
+	inv_cell_size = 1.f / cell;
+	cols = static_cast<int>(ceilf(area.x * inv_cell_size)) + 1;
+	rows = static_cast<int>(ceilf(area.y * inv_cell_size)) + 1;
+	bend.assign(static_cast<size_t>(cols) * rows, 0.f);
+	is_active.assign(static_cast<size_t>(cols) * rows, 0);
+	active.clear();
+	region_cols = (cols + TRAMPLE_REGION_NODES - 1) / TRAMPLE_REGION_NODES;
+	region_rows = (rows + TRAMPLE_REGION_NODES - 1) / TRAMPLE_REGION_NODES;
+	regions.assign(static_cast<size_t>(region_cols) * region_rows, Region{});
+}
+
+size_t TrampleField::regionOf(uint32_t node) const {
+	const int c = static_cast<int>(node % cols) / TRAMPLE_REGION_NODES;
+	const int r = static_cast<int>(node / cols) / TRAMPLE_REGION_NODES;
+	return static_cast<size_t>(r) * region_cols + c;
+}
+
+void TrampleField::activate(uint32_t node) {
+	if (is_active[node]) return;
+
+	is_active[node] = 1;
+	active.push_back(node);
+	addToRegion(node);
+}
+
+void TrampleField::addToRegion(uint32_t node) {
+	// a blade samples the four nodes around it, so anything within a cell of a node is affected
+	const float x = (node % cols) * cell_size;
+	const float y = (node / cols) * cell_size;
+	Rect<float> reach{ x - cell_size, y - cell_size, x + cell_size, y + cell_size };
+
+	Region& region = regions[regionOf(node)];
+	if (region.nodes++ == 0) {
+		region.bounds = reach;
+	}
+	else {
+		region.bounds.left = std::min(region.bounds.left, reach.left);
+		region.bounds.top = std::min(region.bounds.top, reach.top);
+		region.bounds.right = std::max(region.bounds.right, reach.right);
+		region.bounds.bottom = std::max(region.bounds.bottom, reach.bottom);
+	}
+}
+
+void TrampleField::stamp(const Vector2<float> center, float radius, float strength) {
+	if (cols == 0 || radius <= 0.f) return;
+
+	const int c0 = std::max(static_cast<int>(floorf((center.x - radius) * inv_cell_size)), 0);
+	const int c1 = std::min(static_cast<int>(ceilf((center.x + radius) * inv_cell_size)), cols - 1);
+	const int r0 = std::max(static_cast<int>(floorf((center.y - radius) * inv_cell_size)), 0);
+	const int r1 = std::min(static_cast<int>(ceilf((center.y + radius) * inv_cell_size)), rows - 1);
+	const float inv_radius2 = 1.f / (radius * radius);
+	const float inv_side = 4.f / radius; // blades a quarter radius either side of the centre lie fully over
+
+	for (int r = r0; r <= r1; r++) {
+		for (int c = c0; c <= c1; c++) {
+			float dx = c * cell_size - center.x;
+			float dy = r * cell_size - center.y;
+			float falloff = 1.f - (dx * dx + dy * dy) * inv_radius2;
+			if (falloff <= 0.f) continue;
+
+			float push = strength * falloff * std::clamp(dx * inv_side, -1.f, 1.f);
+			uint32_t node = static_cast<uint32_t>(r * cols + c);
+			if (fabsf(push) <= fabsf(bend[node]) || fabsf(push) < TRAMPLE_MIN_BEND) continue;
+
+			bend[node] = push;
+			activate(node);
+		}
+	}
+}
+
+// Decays only the active set; recovered nodes are swapped out and their regions' bounds shrink with it.
+void TrampleField::update(float dt) {
+	if (active.empty()) return;
+
+	const float keep = exp2f(-dt / TRAMPLE_HALF_LIFE);
+	for (uint32_t node : active) {
+		regions[regionOf(node)] = Region{};
+	}
+
+	size_t i = 0;
+	while (i < active.size()) {
+		uint32_t node = active[i];
+		bend[node] *= keep;
+		if (fabsf(bend[node]) < TRAMPLE_MIN_BEND) {
+			bend[node] = 0.f;
+			is_active[node] = 0;
+			active[i] = active.back();
+			active.pop_back();
+			continue;
+		}
+		addToRegion(node);
+		i++;
+	}
+}
+
+// The blade kernels settle a blade at wind / stiffness, so pushing by stiffness * bend leans it
+// over by bend on top of whatever the wind is doing.
+void TrampleField::sampleBlades(BladeField& field, size_t begin, size_t end) const {
+	if (active.empty()) return;
+
+	const float* grid = bend.data();
+	const float max_x = cols - 1.001f;
+	const float max_y = rows - 1.001f;
+
+	for (size_t i = begin; i < end; i++) {
+		const float x = field.root_x[i];
+		const float y = field.root_y[i];
+		float gx = std::clamp(x * inv_cell_size, 0.f, max_x);
+		float gy = std::clamp(y * inv_cell_size, 0.f, max_y);
+		int ix = static_cast<int>(gx);
+		int iy = static_cast<int>(gy);
+		float fx = gx - ix;
+		float fy = gy - iy;
+
+		const float* row0 = grid + static_cast<size_t>(iy) * cols + ix;
+		const float* row1 = row0 + cols;
+		field.wind[i] += field.stiffness[i] * lerp(lerp(row0[0], row0[1], fx), lerp(row1[0], row1[1], fx), fy);
+	}
+}
+
+bool TrampleField::touches(const Rect<float>& area) const {
+	if (active.empty() || area.empty()) return false;
+
+	// a region's bounds reach a cell past its own nodes
+	const float region_size = TRAMPLE_REGION_NODES * cell_size;
+	const int c0 = std::max(static_cast<int>(floorf((area.left - cell_size) / region_size)), 0);
+	const int c1 = std::min(static_cast<int>(floorf((area.right + cell_size) / region_size)), region_cols - 1);
+	const int r0 = std::max(static_cast<int>(floorf((area.top - cell_size) / region_size)), 0);
+	const int r1 = std::min(static_cast<int>(floorf((area.bottom + cell_size) / region_size)), region_rows - 1);
+
+	for (int r = r0; r <= r1; r++) {
+		for (int c = c0; c <= c1; c++) {
+			const Region& region = regions[static_cast<size_t>(r) * region_cols + c];
+			if (region.nodes > 0 && region.bounds.intersects(area)) return true;
+		}
+	}
+	return false;
+}
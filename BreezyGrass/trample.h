@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "types.h"
+
+class BladeField;
+
+constexpr float TRAMPLE_CELL_SIZE = 16.f;    // world units between grid nodes
+constexpr float TRAMPLE_HALF_LIFE = 1.5f;    // seconds for flattened grass to spring halfway back
+constexpr float TRAMPLE_MIN_BEND = 0.005f;   // radians; quieter nodes leave the active set
+constexpr float TRAMPLE_BRUSH_RADIUS = 40.f; // world units, the mouse brush
+constexpr float TRAMPLE_BRUSH_BEND = 1.2f;   // radians blades under the brush are pushed over by
+constexpr int TRAMPLE_REGION_NODES = 8;      // grid nodes per side of a region tracking active bounds
+
+// How far grass has been pushed over by things walking through it, on a coarse grid that
+// persists between steps and springs back over time.
+//
+// Stamps and decay only ever touch the nodes involved: stamped nodes join an active set, each
+// update decays just that set and drops nodes once they have recovered. An untouched meadow
+// costs nothing however large it is. Active nodes are also tracked per region of the grid, each
+// with its own bounds, so a walk across one corner of the meadow only involves the chunks there.
+class TrampleField {
+public:
+	int cols = 0;
+	int rows = 0;
+	float cell_size = TRAMPLE_CELL_SIZE;
+	std::vector<float> bend; // cols * rows, row major; radians, positive leans towards +x
+
+	void init(const Vector2<float> area, float cell = TRAMPLE_CELL_SIZE);
+
+	// flatten grass within radius of center away from it, strongest in the middle.
+	// Overlapping stamps keep the stronger push rather than adding up.
+	void stamp(const Vector2<float> center, float radius, float strength);
+	void update(float dt);
+
+	// adds the push towards each blade's trampled bend onto field.wind, so call after the wind sample.
+	// Every blade in the range samples the grid; skip ranges that touches() rules out.
+	void sampleBlades(BladeField& field, size_t begin, size_t end) const;
+
+	// whether any trampled blade can be inside area
+	bool touches(const Rect<float>& area) const;
+
+	bool empty() const { return active.empty(); }
+	size_t activeNodes() const { return active.size(); }
+
+private:
+	struct Region {
+		uint32_t nodes = 0;  // active nodes inside
+		Rect<float> bounds;  // world area their blades can be in
+	};
+
+	void activate(uint32_t node);
+	void addToRegion(uint32_t node);
+	size_t regionOf(uint32_t node) const;
+
+	float inv_cell_size = 1.f / TRAMPLE_CELL_SIZE;
+	std::vector<uint32_t> active;       // nodes with a non-zero bend, in no particular order
+	std::vector<uint8_t> is_active;     // per node
+	int region_cols = 0;
+	int region_rows = 0;
+	std::vector<Region> regions;        // region_cols * region_rows, row major
+};
@@ -251,6 +251,27 @@ public:
 	Range(T min, T max) : min{ min }, max{ max } {};
 };
 
+// axis aligned box; left/top inclusive, right/bottom exclusive
+template <typename T>
+class Rect {
+public:
+	T left = 0;
+	T top = 0;
+	T right = 0;
+	T bottom = 0;
+
+	Rect() = default;
+	Rect(T left, T top, T right, T bottom) : left{ left }, top{ top }, right{ right }, bottom{ bottom } {};
+
+	T width() const { return right - left; }
+	T height() const { return bottom - top; }
+	bool empty() const { return right <= left || bottom <= top; }
+
+	bool intersects(const Rect& other) const {
+		return left < other.right && other.left < right && top < other.bottom && other.top < bottom;
+	}
+};
+
 struct RGB {
 	uint8_t R = 0;
 	uint8_t G = 0;
@@ -262,6 +283,14 @@ struct RGBA {
 	uint8_t G = 0;
 	uint8_t B = 0;
 	uint8_t A = 0;
+
+	bool operator==(const RGBA& rhs) const {
+		return R == rhs.R && G == rhs.G && B == rhs.B && A == rhs.A;
+	}
+
+	bool operator!=(const RGBA& rhs) const {
+		return !(*this == rhs);
+	}
 };
 
 struct HSL {
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stddef.h>
+#include <math.h>
+#include <algorithm>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#include "types.h"
+#include "blades.h"
+#include "verletkernels.h"
+
+constexpr int VERLET_SEGMENTS = 4;      // segments per blade when the articulated model is on
+constexpr int VERLET_ITERATIONS = 2;    // constraint passes per step
+constexpr float VERLET_BEND = 0.35f;    // share of the bending error removed per pass
+constexpr float VERLET_TIP_FLEX = 0.6f; // how much weaker the pull back to upright is at the tip than at the root
+constexpr size_t VERLET_BLOCK = 256;    // blades solved together, small enough to stay in L1
+
+// Articulated blades for tall grass: SEGMENTS straight pieces joined at nodes, integrated with
+// Verlet and relaxed with position based length and bending constraints.
+//
+// Node positions are relative to the blade's root and stored segment-major, all blades' node 1,
+// then all blades' node 2 and so on, so each pass walks one contiguous stream per node and the
+// loop over blades has no dependencies between iterations. Those loops are the VerletKernels,
+// explicit SIMD per instruction set; SEGMENTS is a template parameter so the loops over nodes unroll.
+//
+// Chunks step at different rates on and off screen, so each blade remembers the length of its
+// last step and the motion carried into the next one is scaled by the ratio (time corrected Verlet).
+//
+// Indices follow the BladeField the model was built from. Every step writes the tip direction
+// back into the field's angle arrays, so anything that only knows about bend angles still works.
+template <int SEGMENTS>
+class VerletBlades {
+	static_assert(SEGMENTS >= 3 && SEGMENTS <= 6, "articulated blades have 3 to 6 segments");
+
+public:
+	size_t capacity = 0;
+
+	VerletBlades() = default;
+	~VerletBlades() { release(); }
+	VerletBlades(const VerletBlades&) = delete;
+	VerletBlades& operator=(const VerletBlades&) = delete;
+
+	// straight blades along each blade's current bend
+	bool build(const BladeField& field);
+	void release();
+
+	// blades [begin, end), both multiples of BLADE_LANES, pushed by field.wind, with the kernels
+	// matching the selected blade kernel
+	void step(BladeField& field, size_t begin, size_t end, float dt);
+	void step(BladeField& field, size_t begin, size_t end, float dt, const VerletKernels& kernels);
+
+	// node k of blade i relative to its root, between the last two steps; node 0 is the root
+	Vector2<float> node(size_t i, int k, float alpha) const {
+		if (k == 0) return Vector2<float>{ 0.f, 0.f };
+		size_t n = (k - 1) * capacity + i;
+		return Vector2<float>{ prev_x[n] + (x[n] - prev_x[n]) * alpha, prev_y[n] + (y[n] - prev_y[n]) * alpha };
+	}
+
+private:
+	float* x = nullptr; // SEGMENTS * capacity, node k at (k - 1) * capacity
+	float* y = nullptr;
+	float* prev_x = nullptr;
+	float* prev_y = nullptr;
+	float* length = nullptr; // rest length of every segment of a blade
+	float* last_dt = nullptr; // length of each blade's previous step
+};
+
+template <int SEGMENTS>
+bool VerletBlades<SEGMENTS>::build(const BladeField& field) {
+	release();
+
+	const size_t nodes = SEGMENTS * field.capacity;
+	x = static_cast<float*>(SDL_SIMDAlloc(nodes * sizeof(float)));
+	y = static_cast<float*>(SDL_SIMDAlloc(nodes * sizeof(float)));
+	prev_x = static_cast<float*>(SDL_SIMDAlloc(nodes * sizeof(float)));
+	prev_y = static_cast<float*>(SDL_SIMDAlloc(nodes * sizeof(float)));
+	length = static_cast<float*>(SDL_SIMDAlloc(field.capacity * sizeof(float)));
+	last_dt = static_cast<float*>(SDL_SIMDAlloc(field.capacity * sizeof(float)));
+	if (!x || !y || !prev_x || !prev_y || !length || !last_dt) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not allocate articulated blades for %zu blades", field.capacity);
+		release();
+		return false;
+	}
+	capacity = field.capacity;
+
+	for (size_t i = 0; i < capacity; i++) {
+		length[i] = bladeHeight(field, i) / SEGMENTS;
+		last_dt[i] = 1.f; // blades start at rest, so there is no motion for it to scale
+		float s = sinf(field.angle[i]);
+		float c = cosf(field.angle[i]);
+		for (int k = 1; k <= SEGMENTS; k++) {
+			size_t n = (k - 1) * capacity + i;
+			x[n] = prev_x[n] = s * length[i] * k;
+			y[n] = prev_y[n] = -c * length[i] * k;
+		}
+	}
+	return true;
+}
+
+template <int SEGMENTS>
+void VerletBlades<SEGMENTS>::release() {
+	SDL_SIMDFree(x);
+	SDL_SIMDFree(y);
+	SDL_SIMDFree(prev_x);
+	SDL_SIMDFree(prev_y);
+	SDL_SIMDFree(length);
+	SDL_SIMDFree(last_dt);
+	x = y = prev_x = prev_y = length = last_dt = nullptr;
+	capacity = 0;
+}
+
+template <int SEGMENTS>
+void VerletBlades<SEGMENTS>::step(BladeField& field, size_t begin, size_t end, float dt) {
+	step(field, begin, end, dt, verletKernels(getBladeKernel()));
+}
+
+template <int SEGMENTS>
+void VerletBlades<SEGMENTS>::step(BladeField& field, size_t begin, size_t end, float dt, const VerletKernels& kernels) {
+	const float keep = std::max(1.f - BLADE_DAMPING * dt, 0.f);
+	const float dt2 = dt * dt;
+
+	for (size_t block = begin; block < end; block += VERLET_BLOCK) {
+		const size_t count = std::min(VERLET_BLOCK, end - block);
+		const float* rest = length + block;
+
+		// damping, and the last step's motion stretched or shrunk to this step's length
+		alignas(64) float carry[VERLET_BLOCK];
+		for (size_t i = 0; i < count; i++) {
+			carry[i] = keep * dt / last_dt[block + i];
+			last_dt[block + i] = dt;
+		}
+
+		// integrate: the wind pushes every node sideways, a spring pulls it back to upright.
+		// The push grows with the node's height so a stiff blade settles at about wind / stiffness,
+		// like the single angle model; the spring weakens up the blade so the tip curls.
+		for (int k = 1; k <= SEGMENTS; k++) {
+			const float flex = 1.f - VERLET_TIP_FLEX * (k - 1) / (SEGMENTS - 1);
+			const size_t n = (k - 1) * capacity + block;
+			kernels.integrate(x + n, y + n, prev_x + n, prev_y + n, field.stiffness + block, field.wind + block, rest, carry, count,
+				static_cast<float>(k), flex, dt2);
+		}
+
+		for (int pass = 0; pass < VERLET_ITERATIONS; pass++) {
+			kernels.relaxRoot(x + block, y + block, rest, 1.f, 1.f, count);
+			for (int k = 2; k <= SEGMENTS; k++) {
+				const size_t a = (k - 2) * capacity + block;
+				const size_t b = (k - 1) * capacity + block;
+				kernels.relax(x + a, y + a, x + b, y + b, rest, 1.f, 1.f, count);
+			}
+			// bending: a node and the one two further along want to stay a straight two segments apart
+			kernels.relaxRoot(x + capacity + block, y + capacity + block, rest, 2.f, VERLET_BEND, count);
+			for (int k = 3; k <= SEGMENTS; k++) {
+				const size_t a = (k - 3) * capacity + block;
+				const size_t b = (k - 1) * capacity + block;
+				kernels.relax(x + a, y + a, x + b, y + b, rest, 2.f, VERLET_BEND, count);
+			}
+		}
+
+		// the tip direction stands in for the bend angle
+		const size_t tip = (SEGMENTS - 1) * capacity + block;
+		kernels.tipAngles(x + tip, y + tip, field.angle + block, field.prev_angle + block, field.angular_velocity + block, count, dt);
+	}
+}
@@ -0,0 +1,453 @@
+// Articulated blade solver passes.
+// As with the blade kernels, every path performs the same operations in the same order
+// (no fused multiply-add), so the vector paths track the scalar reference to rounding.
+
+#include <math.h>
+#include <algorithm>
+
+#pragma warning(push, 0)
+#include "SDL.h"
+#pragma warning(pop)
+#undef main
+
+#include "verletkernels.h"
+#include "verletblades.h"
+#include "blades.h"
+#include "fasttrig.h"
+
+namespace {
+	constexpr float MIN_DISTANCE = 1e-6f; // a zero length blade is all zeros and stays that way
+	constexpr float HALF_PI = static_cast<float>(trig_detail::PI / 2.0);
+	constexpr float PI_F = static_cast<float>(trig_detail::PI);
+
+	void integrateScalar(float* x, float* y, float* prev_x, float* prev_y, const float* stiffness, const float* wind,
+		const float* rest, const float* carry, size_t count, float node, float flex, float dt2) {
+		for (size_t i = 0; i < count; i++) {
+			float spring = stiffness[i] * flex;
+			float rest_y = -rest[i] * node;
+			float ax = wind[i] * rest[i] * node * flex - spring * x[i];
+			float ay = -spring * (y[i] - rest_y);
+
+			float next_x = x[i] + (x[i] - prev_x[i]) * carry[i] + ax * dt2;
+			float next_y = y[i] + (y[i] - prev_y[i]) * carry[i] + ay * dt2;
+			prev_x[i] = x[i];
+			prev_y[i] = y[i];
+			x[i] = next_x;
+			y[i] = next_y;
+		}
+	}
+
+	void relaxRootScalar(float* bx, float* by, const float* rest, float scale, float share, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			float d = std::max(sqrtf(bx[i] * bx[i] + by[i] * by[i]), MIN_DISTANCE);
+			float error = share * (d - rest[i] * scale) / d;
+			bx[i] -= bx[i] * error;
+			by[i] -= by[i] * error;
+		}
+	}
+
+	void relaxScalar(float* ax, float* ay, float* bx, float* by, const float* rest, float scale, float share, size_t count) {
+		const float half_share = 0.5f * share;
+		for (size_t i = 0; i < count; i++) {
+			float dx = bx[i] - ax[i];
+			float dy = by[i] - ay[i];
+			float d = std::max(sqrtf(dx * dx + dy * dy), MIN_DISTANCE);
+			float error = half_share * (d - rest[i] * scale) / d;
+			bx[i] -= dx * error;
+			by[i] -= dy * error;
+			ax[i] += dx * error;
+			ay[i] += dy * error;
+		}
+	}
+
+	void tipAnglesScalar(const float* tip_x, const float* tip_y, float* angle, float* prev_angle, float* velocity, size_t count, float dt) {
+		for (size_t i = 0; i < count; i++) {
+			float a = std::min(std::max(fastAtan2(tip_x[i], -tip_y[i]), -BLADE_MAX_BEND), BLADE_MAX_BEND);
+			prev_angle[i] = angle[i];
+			velocity[i] = (a - angle[i]) / dt;
+			angle[i] = a;
+		}
+	}
+
+#if SIMD_X86
+	// fastAtan2 a lane at a time; selects stand in for its conditionals
+	SIMD_TARGET_SSE2
+	inline __m128 atan2SSE2(__m128 y, __m128 x) {
+		const __m128 sign = _mm_set1_ps(-0.f);
+		const float* c = trig_detail::ATAN_COEFFS;
+		__m128 ax = _mm_andnot_ps(sign, x);
+		__m128 ay = _mm_andnot_ps(sign, y);
+		__m128 a = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(1e-30f)));
+		__m128 s = _mm_mul_ps(a, a);
+		__m128 p = _mm_set1_ps(c[7]);
+		for (int k = 6; k >= 0; k--) {
+			p = _mm_add_ps(_mm_set1_ps(c[k]), _mm_mul_ps(s, p));
+		}
+		__m128 r = _mm_mul_ps(a, p);
+
+		__m128 steep = _mm_cmpgt_ps(ay, ax);
+		r = _mm_or_ps(_mm_and_ps(steep, _mm_sub_ps(_mm_set1_ps(HALF_PI), r)), _mm_andnot_ps(steep, r));
+		__m128 behind = _mm_cmplt_ps(x, _mm_setzero_ps());
+		r = _mm_or_ps(_mm_and_ps(behind, _mm_sub_ps(_mm_set1_ps(PI_F), r)), _mm_andnot_ps(behind, r));
+		return _mm_or_ps(_mm_andnot_ps(sign, r), _mm_and_ps(sign, y));
+	}
+
+	SIMD_TARGET_SSE2
+	void integrateSSE2(float* x, float* y, float* prev_x, float* prev_y, const float* stiffness, const float* wind,
+		const float* rest, const float* carry, size_t count, float node, float flex, float dt2) {
+		const __m128 node_v = _mm_set1_ps(node);
+		const __m128 flex_v = _mm_set1_ps(flex);
+		const __m128 dt2_v = _mm_set1_ps(dt2);
+		const __m128 zero = _mm_setzero_ps();
+
+		for (size_t i = 0; i < count; i += 4) {
+			__m128 nx = _mm_load_ps(x + i);
+			__m128 ny = _mm_load_ps(y + i);
+			__m128 px = _mm_load_ps(prev_x + i);
+			__m128 py = _mm_load_ps(prev_y + i);
+			__m128 r = _mm_load_ps(rest + i);
+			__m128 keep = _mm_load_ps(carry + i);
+
+			__m128 spring = _mm_mul_ps(_mm_load_ps(stiffness + i), flex_v);
+			__m128 rest_y = _mm_mul_ps(_mm_sub_ps(zero, r), node_v);
+			__m128 ax = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_load_ps(wind + i), r), node_v), flex_v), _mm_mul_ps(spring, nx));
+			__m128 ay = _mm_mul_ps(_mm_sub_ps(zero, spring), _mm_sub_ps(ny, rest_y));
+
+			_mm_store_ps(prev_x + i, nx);
+			_mm_store_ps(prev_y + i, ny);
+			_mm_store_ps(x + i, _mm_add_ps(_mm_add_ps(nx, _mm_mul_ps(_mm_sub_ps(nx, px), keep)), _mm_mul_ps(ax, dt2_v)));
+			_mm_store_ps(y + i, _mm_add_ps(_mm_add_ps(ny, _mm_mul_ps(_mm_sub_ps(ny, py), keep)), _mm_mul_ps(ay, dt2_v)));
+		}
+	}
+
+	SIMD_TARGET_SSE2
+	void relaxRootSSE2(float* bx, float* by, const float* rest, float scale, float share, size_t count) {
+		const __m128 scale_v = _mm_set1_ps(scale);
+		const __m128 share_v = _mm_set1_ps(share);
+		const __m128 min_d = _mm_set1_ps(MIN_DISTANCE);
+
+		for (size_t i = 0; i < count; i += 4) {
+			__m128 x = _mm_load_ps(bx + i);
+			__m128 y = _mm_load_ps(by + i);
+			__m128 d = _mm_max_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))), min_d);
+			__m128 error = _mm_div_ps(_mm_mul_ps(share_v, _mm_sub_ps(d, _mm_mul_ps(_mm_load_ps(rest + i), scale_v))), d);
+			_mm_store_ps(bx + i, _mm_sub_ps(x, _mm_mul_ps(x, error)));
+			_mm_store_ps(by + i, _mm_sub_ps(y, _mm_mul_ps(y, error)));
+		}
+	}
+
+	SIMD_TARGET_SSE2
+	void relaxSSE2(float* ax, float* ay, float* bx, float* by, const float* rest, float scale, float share, size_t count) {
+		const __m128 scale_v = _mm_set1_ps(scale);
+		const __m128 half_share = _mm_set1_ps(0.5f * share);
+		const __m128 min_d = _mm_set1_ps(MIN_DISTANCE);
+
+		for (size_t i = 0; i < count; i += 4) {
+			__m128 x0 = _mm_load_ps(ax + i);
+			__m128 y0 = _mm_load_ps(ay + i);
+			__m128 x1 = _mm_load_ps(bx + i);
+			__m128 y1 = _mm_load_ps(by + i);
+			__m128 dx = _mm_sub_ps(x1, x0);
+			__m128 dy = _mm_sub_ps(y1, y0);
+			__m128 d = _mm_max_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))), min_d);
+			__m128 error = _mm_div_ps(_mm_mul_ps(half_share, _mm_sub_ps(d, _mm_mul_ps(_mm_load_ps(rest + i), scale_v))), d);
+			dx = _mm_mul_ps(dx, error);
+			dy = _mm_mul_ps(dy, error);
+			_mm_store_ps(bx + i, _mm_sub_ps(x1, dx));
+			_mm_store_ps(by + i, _mm_sub_ps(y1, dy));
+			_mm_store_ps(ax + i, _mm_add_ps(x0, dx));
+			_mm_store_ps(ay + i, _mm_add_ps(y0, dy));
+		}
+	}
+
+	SIMD_TARGET_SSE2
+	void tipAnglesSSE2(const float* tip_x, const float* tip_y, float* angle, float* prev_angle, float* velocity, size_t count, float dt) {
+		const __m128 lo = _mm_set1_ps(-BLADE_MAX_BEND);
+		const __m128 hi = _mm_set1_ps(BLADE_MAX_BEND);
+		const __m128 dt_v = _mm_set1_ps(dt);
+
+		for (size_t i = 0; i < count; i += 4) {
+			__m128 up = _mm_sub_ps(_mm_setzero_ps(), _mm_load_ps(tip_y + i));
+			__m128 a = _mm_min_ps(_mm_max_ps(atan2SSE2(_mm_load_ps(tip_x + i), up), lo), hi);
+			__m128 old = _mm_load_ps(angle + i);
+			_mm_store_ps(prev_angle + i, old);
+			_mm_store_ps(velocity + i, _mm_div_ps(_mm_sub_ps(a, old), dt_v));
+			_mm_store_ps(angle + i, a);
+		}
+	}
+
+	SIMD_TARGET_AVX2
+	inline __m256 atan2AVX2(__m256 y, __m256 x) {
+		const __m256 sign = _mm256_set1_ps(-0.f);
+		const float* c = trig_detail::ATAN_COEFFS;
+		__m256 ax = _mm256_andnot_ps(sign, x);
+		__m256 ay = _mm256_andnot_ps(sign, y);
+		__m256 a = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_max_ps(_mm256_max_ps(ax, ay), _mm256_set1_ps(1e-30f)));
+		__m256 s = _mm256_mul_ps(a, a);
+		__m256 p = _mm256_set1_ps(c[7]);
+		for (int k = 6; k >= 0; k--) {
+			p = _mm256_add_ps(_mm256_set1_ps(c[k]), _mm256_mul_ps(s, p));
+		}
+		__m256 r = _mm256_mul_ps(a, p);
+
+		r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(HALF_PI), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+		r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI_F), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+		return _mm256_or_ps(_mm256_andnot_ps(sign, r), _mm256_and_ps(sign, y));
+	}
+
+	SIMD_TARGET_AVX2
+	void integrateAVX2(float* x, float* y, float* prev_x, float* prev_y, const float* stiffness, const float* wind,
+		const float* rest, const float* carry, size_t count, float node, float flex, float dt2) {
+		const __m256 node_v = _mm256_set1_ps(node);
+		const __m256 flex_v = _mm256_set1_ps(flex);
+		const __m256 dt2_v = _mm256_set1_ps(dt2);
+		const __m256 zero = _mm256_setzero_ps();
+
+		for (size_t i = 0; i < count; i += 8) {
+			__m256 nx = _mm256_load_ps(x + i);
+			__m256 ny = _mm256_load_ps(y + i);
+			__m256 px = _mm256_load_ps(prev_x + i);
+			__m256 py = _mm256_load_ps(prev_y + i);
+			__m256 r = _mm256_load_ps(rest + i);
+			__m256 keep = _mm256_load_ps(carry + i);
+
+			__m256 spring = _mm256_mul_ps(_mm256_load_ps(stiffness + i), flex_v);
+			__m256 rest_y = _mm256_mul_ps(_mm256_sub_ps(zero, r), node_v);
+			__m256 ax = _mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_load_ps(wind + i), r), node_v), flex_v), _mm256_mul_ps(spring, nx));
+			__m256 ay = _mm256_mul_ps(_mm256_sub_ps(zero, spring), _mm256_sub_ps(ny, rest_y));
+
+			_mm256_store_ps(prev_x + i, nx);
+			_mm256_store_ps(prev_y + i, ny);
+			_mm256_store_ps(x + i, _mm256_add_ps(_mm256_add_ps(nx, _mm256_mul_ps(_mm256_sub_ps(nx, px), keep)), _mm256_mul_ps(ax, dt2_v)));
+			_mm256_store_ps(y + i, _mm256_add_ps(_mm256_add_ps(ny, _mm256_mul_ps(_mm256_sub_ps(ny, py), keep)), _mm256_mul_ps(ay, dt2_v)));
+		}
+	}
+
+	SIMD_TARGET_AVX2
+	void relaxRootAVX2(float* bx, float* by, const float* rest, float scale, float share, size_t count) {
+		const __m256 scale_v = _mm256_set1_ps(scale);
+		const __m256 share_v = _mm256_set1_ps(share);
+		const __m256 min_d = _mm256_set1_ps(MIN_DISTANCE);
+
+		for (size_t i = 0; i < count; i += 8) {
+			__m256 x = _mm256_load_ps(bx + i);
+			__m256 y = _mm256_load_ps(by + i);
+			__m256 d = _mm256_max_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y))), min_d);
+			__m256 error = _mm256_div_ps(_mm256_mul_ps(share_v, _mm256_sub_ps(d, _mm256_mul_ps(_mm256_load_ps(rest + i), scale_v))), d);
+			_mm256_store_ps(bx + i, _mm256_sub_ps(x, _mm256_mul_ps(x, error)));
+			_mm256_store_ps(by + i, _mm256_sub_ps(y, _mm256_mul_ps(y, error)));
+		}
+	}
+
+	SIMD_TARGET_AVX2
+	void relaxAVX2(float* ax, float* ay, float* bx, float* by, const float* rest, float scale, float share, size_t count) {
+		const __m256 scale_v = _mm256_set1_ps(scale);
+		const __m256 half_share = _mm256_set1_ps(0.5f * share);
+		const __m256 min_d = _mm256_set1_ps(MIN_DISTANCE);
+
+		for (size_t i = 0; i < count; i += 8) {
+			__m256 x0 = _mm256_load_ps(ax + i);
+			__m256 y0 = _mm256_load_ps(ay + i);
+			__m256 x1 = _mm256_load_ps(bx + i);
+			__m256 y1 = _mm256_load_ps(by + i);
+			__m256 dx = _mm256_sub_ps(x1, x0);
+			__m256 dy = _mm256_sub_ps(y1, y0);
+			__m256 d = _mm256_max_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy))), min_d);
+			__m256 error = _mm256_div_ps(_mm256_mul_ps(half_share, _mm256_sub_ps(d, _mm256_mul_ps(_mm256_load_ps(rest + i), scale_v))), d);
+			dx = _mm256_mul_ps(dx, error);
+			dy = _mm256_mul_ps(dy, error);
+			_mm256_store_ps(bx + i, _mm256_sub_ps(x1, dx));
+			_mm256_store_ps(by + i, _mm256_sub_ps(y1, dy));
+			_mm256_store_ps(ax + i, _mm256_add_ps(x0, dx));
+			_mm256_store_ps(ay + i, _mm256_add_ps(y0, dy));
+		}
+	}
+
+	SIMD_TARGET_AVX2
+	void tipAnglesAVX2(const float* tip_x, const float* tip_y, float* angle, float* prev_angle, float* velocity, size_t count, float dt) {
+		const __m256 lo = _mm256_set1_ps(-BLADE_MAX_BEND);
+		const __m256 hi = _mm256_set1_ps(BLADE_MAX_BEND);
+		const __m256 dt_v = _mm256_set1_ps(dt);
+
+		for (size_t i = 0; i < count; i += 8) {
+			__m256 up = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_load_ps(tip_y + i));
+			__m256 a = _mm256_min_ps(_mm256_max_ps(atan2AVX2(_mm256_load_ps(tip_x + i), up), lo), hi);
+			__m256 old = _mm256_load_ps(angle + i);
+			_mm256_store_ps(prev_angle + i, old);
+			_mm256_store_ps(velocity + i, _mm256_div_ps(_mm256_sub_ps(a, old), dt_v));
+			_mm256_store_ps(angle + i, a);
+		}
+	}
+
+	// AVX-512F has no float bitwise ops (those are DQ), so signs are handled on the integer side
+	SIMD_TARGET_AVX512
+	inline __m512 atan2AVX512(__m512 y, __m512 x) {
+		const __m512i sign = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+		const float* c = trig_detail::ATAN_COEFFS;
+		__m512 ax = _mm512_abs_ps(x);
+		__m512 ay = _mm512_abs_ps(y);
+		__m512 a = _mm512_div_ps(_mm512_min_ps(ax, ay), _mm512_max_ps(_mm512_max_ps(ax, ay), _mm512_set1_ps(1e-30f)));
+		__m512 s = _mm512_mul_ps(a, a);
+		__m512 p = _mm512_set1_ps(c[7]);
+		for (int k = 6; k >= 0; k--) {
+			p = _mm512_add_ps(_mm512_set1_ps(c[k]), _mm512_mul_ps(s, p));
+		}
+		__m512 r = _mm512_mul_ps(a, p);
+
+		r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(ay, ax, _CMP_GT_OQ), _mm512_set1_ps(HALF_PI), r);
+		r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ), _mm512_set1_ps(PI_F), r);
+		__m512i bits = _mm512_or_si512(_mm512_andnot_si512(sign, _mm512_castps_si512(r)), _mm512_and_si512(sign, _mm512_castps_si512(y)));
+		return _mm512_castsi512_ps(bits);
+	}
+
+	SIMD_TARGET_AVX512
+	void integrateAVX512(float* x, float* y, float* prev_x, float* prev_y, const float* stiffness, const float* wind,
+		const float* rest, const float* carry, size_t count, float node, float flex, float dt2) {
+		const __m512 node_v = _mm512_set1_ps(node);
+		const __m512 flex_v = _mm512_set1_ps(flex);
+		const __m512 dt2_v = _mm512_set1_ps(dt2);
+		const __m512 zero = _mm512_setzero_ps();
+
+		for (size_t i = 0; i < count; i += 16) {
+			__m512 nx = _mm512_load_ps(x + i);
+			__m512 ny = _mm512_load_ps(y + i);
+			__m512 px = _mm512_load_ps(prev_x + i);
+			__m512 py = _mm512_load_ps(prev_y + i);
+			__m512 r = _mm512_load_ps(rest + i);
+			__m512 keep = _mm512_load_ps(carry + i);
+
+			__m512 spring = _mm512_mul_ps(_mm512_load_ps(stiffness + i), flex_v);
+			__m512 rest_y = _mm512_mul_ps(_mm512_sub_ps(zero, r), node_v);
+			__m512 ax = _mm512_sub_ps(_mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(_mm512_load_ps(wind + i), r), node_v), flex_v), _mm512_mul_ps(spring, nx));
+			__m512 ay = _mm512_mul_ps(_mm512_sub_ps(zero, spring), _mm512_sub_ps(ny, rest_y));
+
+			_mm512_store_ps(prev_x + i, nx);
+			_mm512_store_ps(prev_y + i, ny);
+			_mm512_store_ps(x + i, _mm512_add_ps(_mm512_add_ps(nx, _mm512_mul_ps(_mm512_sub_ps(nx, px), keep)), _mm512_mul_ps(ax, dt2_v)));
+			_mm512_store_ps(y + i, _mm512_add_ps(_mm512_add_ps(ny, _mm512_mul_ps(_mm512_sub_ps(ny, py), keep)), _mm512_mul_ps(ay, dt2_v)));
+		}
+	}
+
+	SIMD_TARGET_AVX512
+	void relaxRootAVX512(float* bx, float* by, const float* rest, float scale, float share, size_t count) {
+		const __m512 scale_v = _mm512_set1_ps(scale);
+		const __m512 share_v = _mm512_set1_ps(share);
+		const __m512 min_d = _mm512_set1_ps(MIN_DISTANCE);
+
+		for (size_t i = 0; i < count; i += 16) {
+			__m512 x = _mm512_load_ps(bx + i);
+			__m512 y = _mm512_load_ps(by + i);
+			__m512 d = _mm512_max_ps(_mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y))), min_d);
+			__m512 error = _mm512_div_ps(_mm512_mul_ps(share_v, _mm512_sub_ps(d, _mm512_mul_ps(_mm512_load_ps(rest + i), scale_v))), d);
+			_mm512_store_ps(bx + i, _mm512_sub_ps(x, _mm512_mul_ps(x, error)));
+			_mm512_store_ps(by + i, _mm512_sub_ps(y, _mm512_mul_ps(y, error)));
+		}
+	}
+
+	SIMD_TARGET_AVX512
+	void relaxAVX512(float* ax, float* ay, float* bx, float* by, const float* rest, float scale, float share, size_t count) {
+		const __m512 scale_v = _mm512_set1_ps(scale);
+		const __m512 half_share = _mm512_set1_ps(0.5f * share);
+		const __m512 min_d = _mm512_set1_ps(MIN_DISTANCE);
+
+		for (size_t i = 0; i < count; i += 16) {
+			__m512 x0 = _mm512_load_ps(ax + i);
+			__m512 y0 = _mm512_load_ps(ay + i);
+			__m512 x1 = _mm512_load_ps(bx + i);
+			__m512 y1 = _mm512_load_ps(by + i);
+			__m512 dx = _mm512_sub_ps(x1, x0);
+			__m512 dy = _mm512_sub_ps(y1, y0);
+			__m512 d = _mm512_max_ps(_mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy))), min_d);
+			__m512 error = _mm512_div_ps(_mm512_mul_ps(half_share, _mm512_sub_ps(d, _mm512_mul_ps(_mm512_load_ps(rest + i), scale_v))), d);
+			dx = _mm512_mul_ps(dx, error);
+			dy = _mm512_mul_ps(dy, error);
+			_mm512_store_ps(bx + i, _mm512_sub_ps(x1, dx));
+			_mm512_store_ps(by + i, _mm512_sub_ps(y1, dy));
+			_mm512_store_ps(ax + i, _mm512_add_ps(x0, dx));
+			_mm512_store_ps(ay + i, _mm512_add_ps(y0, dy));
+		}
+	}
+
+	SIMD_TARGET_AVX512
+	void tipAnglesAVX512(const float* tip_x, const float* tip_y, float* angle, float* prev_angle, float* velocity, size_t count, float dt) {
+		const __m512 lo = _mm512_set1_ps(-BLADE_MAX_BEND);
+		const __m512 hi = _mm512_set1_ps(BLADE_MAX_BEND);
+		const __m512 dt_v = _mm512_set1_ps(dt);
+
+		for (size_t i = 0; i < count; i += 16) {
+			__m512 up = _mm512_sub_ps(_mm512_setzero_ps(), _mm512_load_ps(tip_y + i));
+			__m512 a = _mm512_min_ps(_mm512_max_ps(atan2AVX512(_mm512_load_ps(tip_x + i), up), lo), hi);
+			__m512 old = _mm512_load_ps(angle + i);
+			_mm512_store_ps(prev_angle + i, old);
+			_mm512_store_ps(velocity + i, _mm512_div_ps(_mm512_sub_ps(a, old), dt_v));
+			_mm512_store_ps(angle + i, a);
+		}
+	}
+#endif
+
+	const VerletKernels SCALAR_KERNELS{ integrateScalar, relaxRootScalar, relaxScalar, tipAnglesScalar };
+#if SIMD_X86
+	const VerletKernels SSE2_KERNELS{ integrateSSE2, relaxRootSSE2, relaxSSE2, tipAnglesSSE2 };
+	const VerletKernels AVX2_KERNELS{ integrateAVX2, relaxRootAVX2, relaxAVX2, tipAnglesAVX2 };
+	const VerletKernels AVX512_KERNELS{ integrateAVX512, relaxRootAVX512, relaxAVX512, tipAnglesAVX512 };
+#endif
+}
+
+const VerletKernels& verletKernels(eSimdLevel level) {
+	switch (level) {
+#if SIMD_X86
+	case eSimdLevel::SSE2: return SSE2_KERNELS;
+	case eSimdLevel::AVX2: return AVX2_KERNELS;
+	case eSimdLevel::AVX512: return AVX512_KERNELS;
+#endif
+	default: return SCALAR_KERNELS;
+	}
+}
+
+// Same check as validateBladeKernels: a few lanes of articulated blades in a wind that differs
+// per blade and per step, every supported path against scalar.
+float validateVerletKernels() {
+	constexpr size_t test_blades = 4 * BLADE_LANES + 3;
+	constexpr int test_steps = 240;
+	const float dt = 1.f / 120.f;
+	const float slow_dt = 4.f / 120.f; // the rate off screen chunks step at
+
+	auto run = [&](eSimdLevel level, BladeField& field) {
+		if (!field.allocate(test_blades)) return false;
+		seedBlades(field, Vector2<float>{ 100.f, 100.f }, 42);
+
+		VerletBlades<VERLET_SEGMENTS> blades;
+		if (!blades.build(field)) return false;
+
+		const VerletKernels& kernels = verletKernels(level);
+		for (int step = 0; step < test_steps; step++) {
+			for (size_t i = 0; i < field.capacity; i++) {
+				field.wind[i] = 10.f * sinf(step * 0.1f + i * 0.37f);
+			}
+			// switch rates now and then like a chunk scrolling on and off screen
+			blades.step(field, 0, field.capacity, (step / 60) % 2 ? slow_dt : dt, kernels);
+		}
+		return true;
+	};
+
+	BladeField reference;
+	if (!run(eSimdLevel::SCALAR, reference)) return INFINITY;
+
+	float max_error = 0.f;
+	for (eSimdLevel level : { eSimdLevel::SSE2, eSimdLevel::AVX2, eSimdLevel::AVX512 }) {
+		if (!bladeKernelSupported(level)) continue;
+
+		BladeField field;
+		if (!run(level, field)) return INFINITY;
+
+		float error = 0.f;
+		for (size_t i = 0; i < field.count; i++) {
+			error = std::max(error, fabsf(field.angle[i] - reference.angle[i]));
+		}
+
+		SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "Verlet kernels %s max error vs scalar: %g", simdLevelName(level), error);
+		max_error = std::max(max_error, error);
+	}
+
+	return max_error;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "simd.h"
+
+// The passes of the articulated blade solver, one set per instruction set like the blade kernels.
+// Each pass runs over `count` blades of one node stream; count is a multiple of BLADE_LANES and
+// every pointer is aligned like the BladeField arrays, so the vector paths have no scalar tail.
+struct VerletKernels {
+	// Verlet step of node `node` (1 at the first joint): wind pushes it sideways by wind * rest * node * flex,
+	// a spring of stiffness * flex pulls it back towards upright. carry scales the last step's motion,
+	// damping and the ratio of this step's length to the last one's
+	void (*integrate)(float* x, float* y, float* prev_x, float* prev_y, const float* stiffness, const float* wind,
+		const float* rest, const float* carry, size_t count, float node, float flex, float dt2);
+	// move b so it ends up rest * scale from the fixed root
+	void (*relaxRoot)(float* bx, float* by, const float* rest, float scale, float share, size_t count);
+	// move a and b evenly so they end up rest * scale apart
+	void (*relax)(float* ax, float* ay, float* bx, float* by, const float* rest, float scale, float share, size_t count);
+	// tip direction to a clamped bend angle, also writing the previous angle and the angular velocity
+	void (*tipAngles)(const float* tip_x, const float* tip_y, float* angle, float* prev_angle, float* velocity, size_t count, float dt);
+};
+
+// falls back to scalar for levels this build has no kernels for; pick a supported level first
+const VerletKernels& verletKernels(eSimdLevel level);
+
+// largest bend angle difference between any supported path and scalar over a short run
+float validateVerletKernels();
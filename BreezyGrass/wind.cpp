@@ -0,0 +1,206 @@
+#include <math.h>
+#include <algorithm>
+
+#include "wind.h"
+#include "blades.h"
+
+namespace {
+	// eight evenly spaced unit gradients
+	constexpr float GRADIENTS[8][2] = {
+		{ 1.f, 0.f }, { 0.7071f, 0.7071f }, { 0.f, 1.f }, { -0.7071f, 0.7071f },
+		{ -1.f, 0.f }, { -0.7071f, -0.7071f }, { 0.f, -1.f }, { 0.7071f, -0.7071f }
+	};
+
+	inline float fade(float t) {
+		return t * t * t * (t * (t * 6.f - 15.f) + 10.f);
+	}
+
+	inline float lerp(float a, float b, float t) {
+		return a + (b - a) * t;
+	}
+}
+
+void WindField::init(const Vector2<float> area, uint32_t seed, float cell) {
+	extent = area;
+	cell_size = cell;
+	inv_cell_size = 1.f / cell;
+	cols = static_cast<int>(ceilf(area.x * inv_cell_size)) + 1;
+	rows = static_cast<int>(ceilf(area.y * inv_cell_size)) + 1;
+	wind_x.assign(static_cast<size_t>(cols) * rows, 0.f);
+	wind_y.assign(static_cast<size_t>(cols) * rows, 0.f);
+
+	rng_state = seed ? seed : 1;
+	gust_fronts.clear();
+	gust_fronts.reserve(WIND_MAX_GUSTS);
+
+	// shuffled lattice permutation; wrapping indices by the period makes the noise tile
+	for (int i = 0; i < WIND_NOISE_PERIOD; i++) {
+		perm[i] = static_cast<uint8_t>(i);
+	}
+	for (int i = WIND_NOISE_PERIOD - 1; i > 0; i--) {
+		int j = static_cast<int>(nextRandom() * (i + 1));
+		std::swap(perm[i], perm[std::min(j, i)]);
+	}
+}
+
+void WindField::update(float time, float dt) {
+	const Vector2<float> dir{ cosf(params.direction), sinf(params.direction) };
+	const Vector2<float> perp{ -dir.y, dir.x };
+	const float inv_scale = 1.f / params.noise_scale;
+	const float drift = time * params.noise_speed;
+
+	updateGusts(dt);
+
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			float x = c * cell_size;
+			float y = r * cell_size;
+
+			// the noise pattern drifts downwind so gusts of turbulence visibly travel
+			float u = x * inv_scale - dir.x * drift;
+			float v = y * inv_scale - dir.y * drift;
+
+			float along = params.strength * (1.f + params.turbulence * layeredNoise(u, v));
+			along += gustAt(x * dir.x + y * dir.y);
+			float across = params.strength * params.turbulence * layeredNoise(u + 31.7f, v + 12.9f);
+
+			size_t node = static_cast<size_t>(r) * cols + c;
+			wind_x[node] = dir.x * along + perp.x * across;
+			wind_y[node] = dir.y * along + perp.y * across;
+		}
+	}
+}
+
+// bilinear lookup, clamped to the grid
+Vector2<float> WindField::sample(float x, float y) const {
+	if (cols == 0) return Vector2<float>{ 0.f, 0.f };
+
+	float gx = std::clamp(x * inv_cell_size, 0.f, cols - 1.001f);
+	float gy = std::clamp(y * inv_cell_size, 0.f, rows - 1.001f);
+	int ix = static_cast<int>(gx);
+	int iy = static_cast<int>(gy);
+	float fx = gx - ix;
+	float fy = gy - iy;
+
+	size_t n00 = static_cast<size_t>(iy) * cols + ix;
+	size_t n10 = n00 + cols;
+
+	return Vector2<float>{
+		lerp(lerp(wind_x[n00], wind_x[n00 + 1], fx), lerp(wind_x[n10], wind_x[n10 + 1], fx), fy),
+		lerp(lerp(wind_y[n00], wind_y[n00 + 1], fx), lerp(wind_y[n10], wind_y[n10 + 1], fx), fy)
+	};
+}
+
+// Blades are seen side-on and lean left or right, so only the x component drives them.
+void WindField::sampleBlades(BladeField& field, size_t begin, size_t end) const {
+	if (cols == 0) {
+		std::fill(field.wind + begin, field.wind + end, 0.f);
+		return;
+	}
+
+	const float* grid = wind_x.data();
+	const float max_x = cols - 1.001f;
+	const float max_y = rows - 1.001f;
+
+	for (size_t i = begin; i < end; i++) {
+		float gx = std::clamp(field.root_x[i] * inv_cell_size, 0.f, max_x);
+		float gy = std::clamp(field.root_y[i] * inv_cell_size, 0.f, max_y);
+		int ix = static_cast<int>(gx);
+		int iy = static_cast<int>(gy);
+		float fx = gx - ix;
+		float fy = gy - iy;
+
+		const float* row0 = grid + static_cast<size_t>(iy) * cols + ix;
+		const float* row1 = row0 + cols;
+		field.wind[i] = lerp(lerp(row0[0], row0[1], fx), lerp(row1[0], row1[1], fx), fy);
+	}
+}
+
+// 2D gradient noise in roughly [-1, 1], tiling every WIND_NOISE_PERIOD lattice cells
+float WindField::noise(float x, float y) const {
+	constexpr int mask = WIND_NOISE_PERIOD - 1;
+	static_assert((WIND_NOISE_PERIOD & mask) == 0, "noise period must be a power of two");
+
+	float fx = floorf(x);
+	float fy = floorf(y);
+	int ix = static_cast<int>(fx);
+	int iy = static_cast<int>(fy);
+	float dx = x - fx;
+	float dy = y - fy;
+
+	auto corner = [&](int cx, int cy, float ox, float oy) {
+		int h = perm[(perm[(ix + cx) & mask] + iy + cy) & mask] & 7;
+		return GRADIENTS[h][0] * ox + GRADIENTS[h][1] * oy;
+	};
+
+	float n00 = corner(0, 0, dx, dy);
+	float n10 = corner(1, 0, dx - 1.f, dy);
+	float n01 = corner(0, 1, dx, dy - 1.f);
+	float n11 = corner(1, 1, dx - 1.f, dy - 1.f);
+
+	float u = fade(dx);
+	float v = fade(dy);
+	return 1.41421f * lerp(lerp(n00, n10, u), lerp(n01, n11, u), v);
+}
+
+// octaves double in frequency, so every layer still tiles with the base period
+float WindField::layeredNoise(float x, float y) const {
+	float sum = 0.f;
+	float amplitude = 1.f;
+	float total = 0.f;
+	int octaves = std::clamp(params.octaves, 1, WIND_MAX_OCTAVES);
+
+	for (int o = 0; o < octaves; o++) {
+		sum += amplitude * noise(x, y);
+		total += amplitude;
+		x *= 2.f;
+		y *= 2.f;
+		amplitude *= 0.5f;
+	}
+
+	return sum / total;
+}
+
+void WindField::updateGusts(float dt) {
+	const Vector2<float> dir{ cosf(params.direction), sinf(params.direction) };
+
+	// range of the meadow measured along the wind direction
+	float a = 0.f;
+	float b = extent.x * dir.x;
+	float c = extent.y * dir.y;
+	float lo = std::min({ a, b, c, b + c });
+	float hi = std::max({ a, b, c, b + c });
+
+	for (GustFront& gust : gust_fronts) {
+		gust.position += gust.speed * dt;
+	}
+
+	gust_fronts.erase(std::remove_if(gust_fronts.begin(), gust_fronts.end(),
+		[hi](const GustFront& gust) { return gust.position - 3.f * gust.width > hi; }), gust_fronts.end());
+
+	if (gust_fronts.size() < WIND_MAX_GUSTS && nextRandom() < params.gust_rate * dt) {
+		GustFront gust;
+		gust.width = params.gust_width * (0.6f + 0.8f * nextRandom());
+		gust.strength = params.gust_strength * (0.5f + 0.5f * nextRandom());
+		gust.speed = params.gust_speed * (0.7f + 0.6f * nextRandom());
+		gust.position = lo - 3.f * gust.width;
+		gust_fronts.push_back(gust);
+	}
+}
+
+float WindField::gustAt(float along) const {
+	float sum = 0.f;
+	for (const GustFront& gust : gust_fronts) {
+		float d = (along - gust.position) / gust.width;
+		sum += gust.strength * expf(-d * d);
+	}
+	return sum;
+}
+
+// uniform in [0, 1)
+float WindField::nextRandom() {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return static_cast<float>(rng_state >> 8) * (1.f / 16777216.f);
+}
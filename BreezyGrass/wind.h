@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "types.h"
+
+class BladeField;
+
+constexpr float WIND_CELL_SIZE = 32.f; // world units between grid nodes
+constexpr int WIND_NOISE_PERIOD = 64;  // noise repeats every this many lattice cells (power of two)
+constexpr int WIND_MAX_OCTAVES = 6;
+constexpr size_t WIND_MAX_GUSTS = 8;
+
+struct WindParams {
+	float direction = 0.f;        // radians, 0 blows towards +x
+	float strength = 8.f;         // steady push, in blade angular acceleration units
+	float turbulence = 0.6f;      // noise amplitude relative to strength
+	float noise_scale = 256.f;    // world units per noise lattice cell of the first octave
+	float noise_speed = 0.35f;    // lattice cells per second the noise drifts downwind
+	int octaves = 3;
+	float gust_rate = 0.15f;      // average gust fronts spawned per second
+	float gust_strength = 14.f;
+	float gust_width = 180.f;     // world units, half-width of a front
+	float gust_speed = 260.f;     // world units per second
+};
+
+// A band of stronger wind sweeping across the meadow along the wind direction.
+struct GustFront {
+	float position = 0.f; // distance along the wind direction
+	float strength = 0.f;
+	float width = 0.f;
+	float speed = 0.f;
+};
+
+// Wind evaluated once per step on a coarse grid from layered tileable gradient noise and
+// gust fronts. Blades then only bilinearly sample the grid instead of evaluating noise.
+class WindField {
+public:
+	WindParams params;
+
+	int cols = 0;
+	int rows = 0;
+	float cell_size = WIND_CELL_SIZE;
+	std::vector<float> wind_x; // cols * rows, row major
+	std::vector<float> wind_y;
+
+	void init(const Vector2<float> area, uint32_t seed, float cell = WIND_CELL_SIZE);
+	void update(float time, float dt);
+
+	Vector2<float> sample(float x, float y) const;
+	void sampleBlades(BladeField& field, size_t begin, size_t end) const;
+
+	const std::vector<GustFront>& gusts() const { return gust_fronts; }
+
+private:
+	float noise(float x, float y) const;
+	float layeredNoise(float x, float y) const;
+	void updateGusts(float dt);
+	float gustAt(float along) const;
+	float nextRandom();
+
+	Vector2<float> extent{ 0.f, 0.f };
+	float inv_cell_size = 1.f / WIND_CELL_SIZE;
+	uint8_t perm[WIND_NOISE_PERIOD] = {};
+	uint32_t rng_state = 1;
+	std::vector<GustFront> gust_fronts;
+};